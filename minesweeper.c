@@ -1,12 +1,34 @@
 #include <curses.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <time.h>
 
 #define FIELD_WIDTH 20
 #define FIELD_HEIGHT 15
 #define BOM_PERCENTAGE 15
+#define BOMB_PRECISION 16
+#define CHUNK_SIZE 64
+#define WORLD_PATH "minesweeper.world"
+#define WORLD_MAGIC "MSWORLD1"
+#define SOLVER_NODE_BUDGET 4000000
+#define SOLVER_PARALLEL_CELLS 20
+#define SOLVER_MAX_THREADS 16
+#define SOLVER_EPSILON 1e-9
+#define GENERATOR_MAX_THREADS 64
+#define GENERATOR_MAX_ATTEMPTS 200000
+#define SIMULATION_GAMES 10000
+#define SIMULATION_SEED 12345
+
+#define SOLVER_UNKNOWN 0
+#define SOLVER_OPEN 1
+#define SOLVER_SAFE 2
+#define SOLVER_MINE 3
 
 typedef struct
 {
@@ -16,35 +38,325 @@ typedef struct
 
 typedef struct
 {
-  bool has_bomb;
-  bool has_marked;
-  bool has_revealed;
-  int adjacent_bombs;
-} Cell;
+  int64_t x;
+  int64_t y;
+} vec2l;
+
+typedef struct
+{
+  int cell;
+  int need;
+  int count;
+  int vars[8];
+} Constraint;
+
+typedef struct
+{
+  const Constraint *constraints;
+  const int (*links)[8];
+  const uint8_t *link_count;
+  const int *local;
+  int *cells;
+  int size;
+  int *need;
+  int *assigned;
+  int *remaining;
+  int members;
+  int *stack;
+  double *totals;
+  double *mines;
+  long nodes;
+  bool exhausted;
+} Component;
+
+typedef struct
+{
+  int width;
+  int height;
+  uint8_t *status;
+  uint8_t *numbers;
+  Constraint *constraints;
+  int constraint_count;
+  int *constraint_at;
+  int (*links)[8];
+  uint8_t *link_count;
+  int *local;
+  int *position;
+  int *order;
+  double *probability;
+  int *safe;
+  int safe_count;
+  int *mines;
+  int mine_count;
+  int guess;
+  double guess_probability;
+  bool exact;
+  bool parallel;
+  bool logic_only;
+  long nodes;
+} Solver;
+
+typedef struct
+{
+  Component **components;
+  int count;
+  atomic_int next;
+} SolverQueue;
+
+// Helpers for solver_probabilities, started on first use and kept for the
+// life of the process; the calling thread drains the queue alongside them.
+typedef struct
+{
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  pthread_t threads[SOLVER_MAX_THREADS];
+  int thread_count;
+  bool started;
+  int job;
+  int active;
+  SolverQueue *queue;
+} SolverPool;
 
 typedef struct
 {
-  Cell field[FIELD_WIDTH][FIELD_HEIGHT];
+  int width;
+  int height;
+  int stride;
+  uint64_t *bombs;
+  uint64_t *marked;
+  uint64_t *revealed;
+  uint64_t *adjacent[4];
+  uint64_t rng;
+  vec2 *flood;
+  size_t flood_count;
+  size_t flood_capacity;
+  int *candidates;
   vec2 cursor;
+  vec2 view;
   bool game_over;
   bool won;
-  int bombs_total;
-  int cells_revealed;
-  int flags_placed;
+  long bombs_total;
+  long cells_revealed;
+  long flags_placed;
+  long mines;
+  bool no_guess;
+  bool pending;
+  Solver solver;
+  char message[96];
 } GameState;
 
-void init_game_state(GameState *state);
+typedef struct
+{
+  int width;
+  int height;
+  long mines;
+} SimConfig;
+
+typedef struct
+{
+  const SimConfig *config;
+  uint64_t seed;
+  long games;
+  atomic_long next;
+} SimJob;
+
+typedef struct
+{
+  SimJob *job;
+  long wins;
+  long moves;
+  long guesses;
+  double generate_ms;
+  double reveal_ms;
+  double solve_ms;
+} SimWorker;
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  pthread_t threads[GENERATOR_MAX_THREADS];
+  int thread_count;
+  int job;
+  int active;
+  int width;
+  int height;
+  long mines;
+  vec2 first;
+  uint64_t seed;
+  atomic_bool found;
+  atomic_long attempts;
+  uint64_t *result;
+} Generator;
+
+typedef struct
+{
+  int64_t cx;
+  int64_t cy;
+  uint64_t bombs[CHUNK_SIZE];
+  uint64_t adjacent[4][CHUNK_SIZE];
+  uint64_t revealed[CHUNK_SIZE];
+  uint64_t marked[CHUNK_SIZE];
+} Chunk;
+
+typedef struct
+{
+  uint64_t seed;
+  Chunk **chunks;
+  size_t capacity;
+  size_t count;
+  vec2l *flood;
+  size_t flood_count;
+  size_t flood_capacity;
+  vec2l cursor;
+  vec2l view;
+  bool game_over;
+  long cells_revealed;
+  long flags_placed;
+} World;
+
+void init_game_state(GameState *state, int width, int height);
+void resize_game_state(GameState *state, int width, int height);
+void free_game_state(GameState *state);
 void game_loop(GameState *state, WINDOW *win);
 void handle_input(GameState *state, WINDOW *win);
 void draw_field(GameState *state);
 void reveal_cell(GameState *state, int x, int y);
+void flood_reveal(GameState *state, int x, int y);
+void flood_push(GameState *state, int x, int y);
+void reveal_row(GameState *state, int y, int from, int to);
+uint64_t flood_mask(GameState *state, int y, int w);
+void place_bombs(GameState *state);
 void calculate_adjacent_bombs(GameState *state);
 int count_adjacent_bombs(GameState *state, int x, int y);
 bool check_win(GameState *state);
+uint64_t next_random(uint64_t *rng);
+uint64_t random_bombs(uint64_t *rng);
+void world_init(World *world, uint64_t seed);
+void world_free(World *world);
+Chunk *world_chunk(World *world, int64_t cx, int64_t cy, bool create);
+void chunk_bombs(uint64_t seed, int64_t cx, int64_t cy, uint64_t bombs[CHUNK_SIZE]);
+void chunk_adjacent(World *world, Chunk *chunk);
+void world_reveal(World *world, int64_t x, int64_t y);
+void world_push(World *world, int64_t x, int64_t y);
+bool world_save(World *world, const char *path);
+bool world_load(World *world, const char *path);
+void endless_loop(World *world, WINDOW *win);
+void world_handle_input(World *world, WINDOW *win);
+void draw_world(World *world);
+void solver_init(Solver *solver, int width, int height);
+void solver_free(Solver *solver);
+bool solver_analyze(Solver *solver, GameState *state);
+void solver_mark(Solver *solver, int cell, int status);
+void solver_compact(Solver *solver, Constraint *constraint);
+bool solver_rules(Solver *solver);
+void solver_probabilities(Solver *solver, GameState *state);
+void enumerate_component(Component *comp, int depth, int mines);
+void *solver_worker(void *arg);
+void solver_drain(SolverQueue *queue);
+void convolve(const double *a, int a_size, const double *b, int b_size, double *out);
+void give_hint(GameState *state);
+void place_mines(GameState *state, long count, int safe_x, int safe_y, uint64_t *rng);
+long mine_capacity(GameState *state, int safe_x, int safe_y);
+bool logic_solvable(GameState *state, int x, int y);
+void generate_no_guess(GameState *state, int x, int y);
+void *generator_worker(void *arg);
+int run_simulation(long games, uint64_t seed);
+void *simulation_worker(void *arg);
+bool simulate_game(GameState *state, const SimConfig *config, uint64_t seed, SimWorker *stats);
+double clock_ms(void);
+
+static const SimConfig SIM_CONFIGS[] = {
+    {9, 9, 10}, {16, 16, 40}, {30, 16, 99}, {30, 16, 72}, {30, 16, 120}, {64, 64, 614}, {100, 100, 1500}};
+
+static SolverPool solver_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER};
+
+static Generator generator = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER};
+
+static inline bool get_bit(const GameState *state, const uint64_t *plane, int x, int y)
+{
+  return (plane[(size_t)y * state->stride + x / 64] >> (x % 64)) & 1;
+}
+
+static inline void set_bit(const GameState *state, uint64_t *plane, int x, int y)
+{
+  plane[(size_t)y * state->stride + x / 64] |= 1ULL << (x % 64);
+}
+
+static inline void clear_bit(const GameState *state, uint64_t *plane, int x, int y)
+{
+  plane[(size_t)y * state->stride + x / 64] &= ~(1ULL << (x % 64));
+}
+
+static inline int64_t chunk_coord(int64_t v)
+{
+  return v >= 0 ? v / CHUNK_SIZE : -((-v - 1) / CHUNK_SIZE) - 1;
+}
+
+static inline uint64_t chunk_hash(int64_t cx, int64_t cy)
+{
+  uint64_t h = (uint64_t)cx * 0x9E3779B97F4A7C15ULL ^ (uint64_t)cy * 0xC2B2AE3D27D4EB4FULL;
+  return h ^ (h >> 29);
+}
 
-int main(void)
+int main(int argc, char **argv)
 {
-  srand(time(NULL));
+  int width = FIELD_WIDTH;
+  int height = FIELD_HEIGHT;
+  bool endless = false;
+  bool no_guess = false;
+  bool simulate = false;
+  long games = SIMULATION_GAMES;
+  uint64_t seed = SIMULATION_SEED;
+  long mines = 0;
+  int sizes = 0;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--endless") == 0)
+      endless = true;
+    else if (strcmp(argv[i], "--no-guess") == 0)
+      no_guess = true;
+    else if (strcmp(argv[i], "--mines") == 0 && i + 1 < argc)
+      mines = atol(argv[++i]);
+    else if (strcmp(argv[i], "--simulate") == 0)
+      simulate = true;
+    else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc)
+      games = atol(argv[++i]);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+      seed = strtoull(argv[++i], NULL, 10);
+    else if (sizes++ == 0)
+      width = atoi(argv[i]);
+    else
+      height = atoi(argv[i]);
+  }
+  if (width < 1 || height < 1 || sizes == 1 || mines < 0 || mines > (long)width * height - 9)
+  {
+    fprintf(stderr, "Uso: %s [LARGURA ALTURA] [--mines N] [--no-guess] [--endless]\n", argv[0]);
+    fprintf(stderr, "     %s --simulate [--games N] [--seed N]\n", argv[0]);
+    return 1;
+  }
+
+  if (simulate)
+    return run_simulation(games, seed);
+
+  GameState state;
+  memset(&state, 0, sizeof(state));
+  state.rng = time(NULL);
+  state.solver.parallel = true;
+  state.mines = mines;
+  state.no_guess = no_guess;
+
+  World world;
+  memset(&world, 0, sizeof(world));
+  bool loaded = endless && world_load(&world, WORLD_PATH);
 
   WINDOW *win = initscr();
   keypad(win, true);
@@ -52,12 +364,21 @@ int main(void)
   curs_set(0);
   noecho();
 
-  GameState state;
-
   while (true)
   {
-    init_game_state(&state);
-    game_loop(&state, win);
+    if (endless)
+    {
+      if (!loaded)
+        world_init(&world, next_random(&state.rng));
+      loaded = false;
+      endless_loop(&world, win);
+      state.won = false;
+    }
+    else
+    {
+      init_game_state(&state, width, height);
+      game_loop(&state, win);
+    }
 
     nodelay(win, false);
     erase();
@@ -81,6 +402,8 @@ int main(void)
       if (pressed == 27)
       {
         endwin();
+        free_game_state(&state);
+        world_free(&world);
         return 0;
       }
       if (pressed == '\n' || pressed == KEY_ENTER)
@@ -92,122 +415,302 @@ int main(void)
   }
 }
 
-void init_game_state(GameState *state)
+void init_game_state(GameState *state, int width, int height)
 {
-  state->bombs_total = 0;
+  resize_game_state(state, width, height);
+
+  size_t bytes = (size_t)state->stride * height * sizeof(uint64_t);
+  memset(state->marked, 0, bytes);
+  memset(state->revealed, 0, bytes);
+
   state->cells_revealed = 0;
   state->flags_placed = 0;
   state->game_over = false;
   state->won = false;
+  state->pending = false;
   state->cursor.x = 0;
   state->cursor.y = 0;
+  state->view.x = 0;
+  state->view.y = 0;
+  state->message[0] = '\0';
 
-  for (int x = 0; x < FIELD_WIDTH; x++)
+  if (state->no_guess)
   {
-    for (int y = 0; y < FIELD_HEIGHT; y++)
-    {
-      state->field[x][y].has_marked = false;
-      state->field[x][y].has_marked = false;
-      state->field[x][y].has_revealed = false;
-      state->field[x][y].adjacent_bombs = 0;
+    memset(state->bombs, 0, bytes);
+    state->bombs_total = state->mines > 0 ? state->mines : (long)width * height * BOM_PERCENTAGE / 100;
+    state->pending = true;
+  }
+  else if (state->mines > 0)
+  {
+    place_mines(state, state->mines, -2, -2, &state->rng);
+  }
+  else
+  {
+    place_bombs(state);
+  }
+  calculate_adjacent_bombs(state);
+}
 
-      if ((rand() % 100) < BOM_PERCENTAGE)
-      {
-        state->field[x][y].has_bomb = true;
-        state->bombs_total++;
-      }
-      else
-      {
-        state->field[x][y].has_bomb = false;
-      }
-    }
+void resize_game_state(GameState *state, int width, int height)
+{
+  if (state->bombs == NULL || state->width != width || state->height != height)
+  {
+    free_game_state(state);
+    state->width = width;
+    state->height = height;
+    state->stride = (width + 63) / 64;
+
+    size_t words = (size_t)state->stride * height;
+    state->bombs = malloc(words * sizeof(uint64_t));
+    state->marked = malloc(words * sizeof(uint64_t));
+    state->revealed = malloc(words * sizeof(uint64_t));
+    for (int i = 0; i < 4; i++)
+      state->adjacent[i] = malloc(words * sizeof(uint64_t));
+    state->candidates = malloc((size_t)width * height * sizeof(int));
   }
+}
 
-  calculate_adjacent_bombs(state);
+void free_game_state(GameState *state)
+{
+  free(state->bombs);
+  free(state->marked);
+  free(state->revealed);
+  for (int i = 0; i < 4; i++)
+  {
+    free(state->adjacent[i]);
+    state->adjacent[i] = NULL;
+  }
+  free(state->flood);
+  free(state->candidates);
+  solver_free(&state->solver);
+  state->bombs = NULL;
+  state->marked = NULL;
+  state->revealed = NULL;
+  state->flood = NULL;
+  state->flood_capacity = 0;
+  state->candidates = NULL;
 }
 
-void calculate_adjacent_bombs(GameState *state)
+uint64_t next_random(uint64_t *rng)
+{
+  uint64_t z = (*rng += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+uint64_t random_bombs(uint64_t *rng)
+{
+  uint32_t threshold = (uint32_t)BOM_PERCENTAGE * (1 << BOMB_PRECISION) / 100;
+  uint64_t bombs = 0;
+  for (int bit = 0; bit < BOMB_PRECISION; bit++)
+  {
+    uint64_t random = next_random(rng);
+    bombs = (threshold >> bit) & 1 ? bombs | random : bombs & random;
+  }
+  return bombs;
+}
+
+void place_bombs(GameState *state)
 {
-  for (int x = 0; x < FIELD_WIDTH; x++)
+  uint64_t tail = state->width % 64 == 0 ? ~0ULL : (1ULL << (state->width % 64)) - 1;
+
+  state->bombs_total = 0;
+  for (int y = 0; y < state->height; y++)
   {
-    for (int y = 0; y < FIELD_HEIGHT; y++)
+    uint64_t *row = state->bombs + (size_t)y * state->stride;
+    for (int w = 0; w < state->stride; w++)
     {
-      if (!state->field[x][y].has_bomb)
-      {
-        state->field[x][y].adjacent_bombs = count_adjacent_bombs(state, x, y);
-      }
+      uint64_t bombs = random_bombs(&state->rng);
+      if (w == state->stride - 1)
+        bombs &= tail;
+
+      row[w] = bombs;
+      state->bombs_total += __builtin_popcountll(bombs);
     }
   }
 }
 
-int count_adjacent_bombs(GameState *state, int x, int y)
+static inline void full_add(uint64_t a, uint64_t b, uint64_t c, uint64_t *sum, uint64_t *carry)
 {
-  int count = 0;
+  uint64_t partial = a ^ b;
+  *sum = partial ^ c;
+  *carry = (a & b) | (partial & c);
+}
+
+static inline uint64_t shift_east(const uint64_t *row, int w)
+{
+  return (row[w] << 1) | (w > 0 ? row[w - 1] >> 63 : 0);
+}
+
+static inline uint64_t shift_west(const uint64_t *row, int w, int stride)
+{
+  return (row[w] >> 1) | (w + 1 < stride ? row[w + 1] << 63 : 0);
+}
+
+void calculate_adjacent_bombs(GameState *state)
+{
+  int stride = state->stride;
+  uint64_t *empty = calloc(stride, sizeof(uint64_t));
 
-  for (int dx = -1; dx <= 1; dx++)
+  for (int y = 0; y < state->height; y++)
   {
-    for (int dy = -1; dy <= 1; dy++)
-    {
-      if (dx == 0 && dy == 0)
-        continue;
+    const uint64_t *up = y > 0 ? state->bombs + (size_t)(y - 1) * stride : empty;
+    const uint64_t *mid = state->bombs + (size_t)y * stride;
+    const uint64_t *down = y + 1 < state->height ? state->bombs + (size_t)(y + 1) * stride : empty;
+    size_t base = (size_t)y * stride;
 
-      int nx = x + dx;
-      int ny = y + dy;
+    for (int w = 0; w < stride; w++)
+    {
+      uint64_t s1, c1, s2, c2, s3, c3, s4, c4, b0, b1, b2, b3;
+      full_add(shift_east(up, w), up[w], shift_west(up, w, stride), &s1, &c1);
+      full_add(shift_east(down, w), down[w], shift_west(down, w, stride), &s2, &c2);
+      full_add(s1, s2, shift_east(mid, w), &s3, &c3);
+      full_add(s3, shift_west(mid, w, stride), 0, &b0, &c4);
+      full_add(c1, c2, c3, &s4, &b2);
+      full_add(s4, c4, 0, &b1, &b3);
 
-      if (nx >= 0 && nx < FIELD_WIDTH && ny >= 0 && ny < FIELD_HEIGHT)
-      {
-        if (state->field[nx][ny].has_bomb)
-        {
-          count++;
-        }
-      }
+      state->adjacent[0][base + w] = b0;
+      state->adjacent[1][base + w] = b1;
+      state->adjacent[2][base + w] = b2 ^ b3;
+      state->adjacent[3][base + w] = b2 & b3;
     }
   }
 
+  free(empty);
+}
+
+int count_adjacent_bombs(GameState *state, int x, int y)
+{
+  int count = 0;
+  for (int bit = 0; bit < 4; bit++)
+    count |= get_bit(state, state->adjacent[bit], x, y) << bit;
   return count;
 }
 
+static inline uint64_t span_mask(int from, int to)
+{
+  uint64_t high = to == 63 ? ~0ULL : (1ULL << (to + 1)) - 1;
+  return high & (~0ULL << from);
+}
+
 void reveal_cell(GameState *state, int x, int y)
 {
-  if (x < 0 || x >= FIELD_WIDTH || y < 0 || y >= FIELD_HEIGHT)
+  if (x < 0 || x >= state->width || y < 0 || y >= state->height)
   {
     return;
   }
 
-  Cell *cell = &state->field[x][y];
-
-  if (cell->has_revealed || cell->has_marked)
+  if (get_bit(state, state->revealed, x, y) || get_bit(state, state->marked, x, y))
   {
     return;
   }
 
-  cell->has_revealed = true;
-  state->cells_revealed++;
-
-  if (cell->has_bomb)
+  if (get_bit(state, state->bombs, x, y))
   {
+    set_bit(state, state->revealed, x, y);
+    state->cells_revealed++;
     state->game_over = true;
     state->won = false;
     return;
   }
 
-  if (cell->adjacent_bombs == 0)
+  if (count_adjacent_bombs(state, x, y) != 0)
   {
-    for (int dx = -1; dx <= 1; dx++)
+    set_bit(state, state->revealed, x, y);
+    state->cells_revealed++;
+    return;
+  }
+
+  flood_reveal(state, x, y);
+}
+
+uint64_t flood_mask(GameState *state, int y, int w)
+{
+  size_t i = (size_t)y * state->stride + w;
+  uint64_t mask = ~(state->bombs[i] | state->revealed[i] | state->marked[i] |
+                    state->adjacent[0][i] | state->adjacent[1][i] | state->adjacent[2][i] | state->adjacent[3][i]);
+  if (w == state->stride - 1 && state->width % 64 != 0)
+    mask &= (1ULL << (state->width % 64)) - 1;
+  return mask;
+}
+
+void flood_push(GameState *state, int x, int y)
+{
+  if (state->flood_count == state->flood_capacity)
+  {
+    state->flood_capacity = state->flood_capacity == 0 ? 1024 : state->flood_capacity * 2;
+    state->flood = realloc(state->flood, state->flood_capacity * sizeof(vec2));
+  }
+  state->flood[state->flood_count++] = (vec2){x, y};
+}
+
+void flood_reveal(GameState *state, int x, int y)
+{
+  state->flood_count = 0;
+  flood_push(state, x, y);
+
+  while (state->flood_count > 0)
+  {
+    vec2 seed = state->flood[--state->flood_count];
+    if (!((flood_mask(state, seed.y, seed.x / 64) >> (seed.x % 64)) & 1))
+      continue;
+
+    int w = seed.x / 64;
+    uint64_t blockers = ~flood_mask(state, seed.y, w) & (~0ULL << (seed.x % 64));
+    while (blockers == 0 && w + 1 < state->stride)
+      blockers = ~flood_mask(state, seed.y, ++w);
+    int right = blockers == 0 ? state->width - 1 : w * 64 + __builtin_ctzll(blockers) - 1;
+
+    w = seed.x / 64;
+    blockers = ~flood_mask(state, seed.y, w) & ((1ULL << (seed.x % 64)) - 1);
+    while (blockers == 0 && w > 0)
+      blockers = ~flood_mask(state, seed.y, --w);
+    int left = blockers == 0 ? 0 : w * 64 + (63 - __builtin_clzll(blockers)) + 1;
+
+    for (w = left / 64; w <= right / 64; w++)
     {
-      for (int dy = -1; dy <= 1; dy++)
-      {
-        if (dx == 0 && dy == 0)
-          continue;
-        reveal_cell(state, x + dx, y + dy);
-      }
+      uint64_t span = span_mask(w == left / 64 ? left % 64 : 0, w == right / 64 ? right % 64 : 63);
+      state->revealed[(size_t)seed.y * state->stride + w] |= span;
+    }
+    state->cells_revealed += right - left + 1;
+
+    int from = left > 0 ? left - 1 : 0;
+    int to = right + 1 < state->width ? right + 1 : right;
+    for (int row = seed.y - 1; row <= seed.y + 1; row++)
+    {
+      if (row >= 0 && row < state->height)
+        reveal_row(state, row, from, to);
+    }
+  }
+}
+
+void reveal_row(GameState *state, int y, int from, int to)
+{
+  uint64_t carry = 0;
+  for (int w = from / 64; w <= to / 64; w++)
+  {
+    size_t i = (size_t)y * state->stride + w;
+    uint64_t span = span_mask(w == from / 64 ? from % 64 : 0, w == to / 64 ? to % 64 : 63);
+    uint64_t zero = flood_mask(state, y, w) & span;
+    uint64_t numbers = span & ~(state->revealed[i] | state->marked[i] | zero);
+
+    state->revealed[i] |= numbers;
+    state->cells_revealed += __builtin_popcountll(numbers);
+
+    uint64_t starts = zero & ~((zero << 1) | carry);
+    carry = zero >> 63;
+    while (starts)
+    {
+      flood_push(state, w * 64 + __builtin_ctzll(starts), y);
+      starts &= starts - 1;
     }
   }
 }
 
 bool check_win(GameState *state)
 {
-  int safe_cells = (FIELD_WIDTH * FIELD_HEIGHT) - state->bombs_total;
+  long safe_cells = (long)state->width * state->height - state->bombs_total;
   return state->cells_revealed >= safe_cells;
 }
 
@@ -226,10 +729,12 @@ void game_loop(GameState *state, WINDOW *win)
     erase();
     draw_field(state);
 
-    mvprintw(FIELD_HEIGHT + 2, 0, "Bombas: %d | Bandeiras: %d | Reveladas: %d/%d",
+    int view_height = state->height < LINES - 5 ? state->height : LINES - 5;
+    mvprintw(view_height + 2, 0, "Bombas: %ld | Bandeiras: %ld | Reveladas: %ld/%ld",
              state->bombs_total, state->flags_placed, state->cells_revealed,
-             (FIELD_WIDTH * FIELD_HEIGHT) - state->bombs_total);
-    mvprintw(FIELD_HEIGHT + 3, 0, "ENTER: Revelar | ESPAÇO: Marcar | ESC: Sair");
+             (long)state->width * state->height - state->bombs_total);
+    mvprintw(view_height + 3, 0, "ENTER: Revelar | ESPAÇO: Marcar | H: Dica | ESC: Sair");
+    mvprintw(view_height + 4, 0, "%s", state->message);
 
     refresh();
     usleep(50000);
@@ -245,13 +750,13 @@ void handle_input(GameState *state, WINDOW *win)
     state->cursor.y--;
     if (state->cursor.y < 0)
     {
-      state->cursor.y = FIELD_HEIGHT - 1;
+      state->cursor.y = state->height - 1;
     }
   }
   else if (pressed == KEY_DOWN)
   {
     state->cursor.y++;
-    if (state->cursor.y >= FIELD_HEIGHT)
+    if (state->cursor.y >= state->height)
     {
       state->cursor.y = 0;
     }
@@ -259,7 +764,7 @@ void handle_input(GameState *state, WINDOW *win)
   else if (pressed == KEY_RIGHT)
   {
     state->cursor.x++;
-    if (state->cursor.x >= FIELD_WIDTH)
+    if (state->cursor.x >= state->width)
     {
       state->cursor.x = 0;
     }
@@ -269,26 +774,34 @@ void handle_input(GameState *state, WINDOW *win)
     state->cursor.x--;
     if (state->cursor.x < 0)
     {
-      state->cursor.x = FIELD_WIDTH - 1;
+      state->cursor.x = state->width - 1;
     }
   }
   else if (pressed == '\n' || pressed == KEY_ENTER)
   {
+    state->message[0] = '\0';
+    if (state->pending)
+      generate_no_guess(state, state->cursor.x, state->cursor.y);
     reveal_cell(state, state->cursor.x, state->cursor.y);
   }
+  else if (pressed == 'h' || pressed == 'H')
+  {
+    give_hint(state);
+  }
   else if (pressed == ' ')
   {
-    Cell *cell = &state->field[state->cursor.x][state->cursor.y];
-    if (!cell->has_revealed)
+    int x = state->cursor.x;
+    int y = state->cursor.y;
+    if (!get_bit(state, state->revealed, x, y))
     {
-      if (cell->has_marked)
+      if (get_bit(state, state->marked, x, y))
       {
-        cell->has_marked = false;
+        clear_bit(state, state->marked, x, y);
         state->flags_placed--;
       }
       else
       {
-        cell->has_marked = true;
+        set_bit(state, state->marked, x, y);
         state->flags_placed++;
       }
     }
@@ -302,45 +815,64 @@ void handle_input(GameState *state, WINDOW *win)
 
 void draw_field(GameState *state)
 {
+  int view_width = state->width < (COLS - 2) / 2 ? state->width : (COLS - 2) / 2;
+  int view_height = state->height < LINES - 5 ? state->height : LINES - 5;
+  if (view_width < 1)
+    view_width = 1;
+  if (view_height < 1)
+    view_height = 1;
+
+  if (state->cursor.x < state->view.x)
+    state->view.x = state->cursor.x;
+  else if (state->cursor.x >= state->view.x + view_width)
+    state->view.x = state->cursor.x - view_width + 1;
+  if (state->cursor.y < state->view.y)
+    state->view.y = state->cursor.y;
+  else if (state->cursor.y >= state->view.y + view_height)
+    state->view.y = state->cursor.y - view_height + 1;
+
   mvaddch(0, 0, '+');
-  for (int x = 0; x < FIELD_WIDTH; x++)
+  for (int x = 0; x < view_width * 2; x++)
   {
     mvaddch(0, x + 1, '-');
   }
-  mvaddch(0, FIELD_WIDTH, '+');
+  mvaddch(0, view_width * 2 + 1, '+');
 
-  for (int y = 0; y < FIELD_HEIGHT; y++)
+  for (int row = 0; row < view_height; row++)
   {
-    mvaddch(y + 1, 0, '|');
-    for (int x = 0; x < FIELD_WIDTH; x++)
+    int y = state->view.y + row;
+    mvaddch(row + 1, 0, '|');
+    for (int col = 0; col < view_width; col++)
     {
-      Cell *cell = &state->field[x][y];
-      int screen_x = x * 2 + 1;
-      int screen_y = y + 1;
+      int x = state->view.x + col;
+      int screen_x = col * 2 + 1;
+      int screen_y = row + 1;
+      bool bomb = get_bit(state, state->bombs, x, y);
 
       if (state->cursor.x == x && state->cursor.y == y)
       {
         attron(A_REVERSE);
       }
 
-      if (cell->has_revealed)
+      if (get_bit(state, state->revealed, x, y) || (bomb && state->game_over && !state->won))
       {
-        if (cell->has_bomb)
+        int adjacent = count_adjacent_bombs(state, x, y);
+        if (bomb)
         {
           attron(A_BOLD);
           mvaddch(screen_y, screen_x, '*');
           attroff(A_BOLD);
         }
-        else if (cell->adjacent_bombs > 0)
+        else if (adjacent > 0)
         {
-          mvprintw(screen_y, screen_x, "%d", cell->adjacent_bombs);
+          mvprintw(screen_y, screen_x, "%d", adjacent);
         }
         else
         {
           mvaddch(screen_y, screen_x, ' ');
         }
       }
-      else if (cell->has_marked)
+      else if (get_bit(state, state->marked, x, y))
       {
         attron(A_BOLD);
         mvaddch(screen_y, screen_x, 'F');
@@ -355,29 +887,1324 @@ void draw_field(GameState *state)
       mvaddch(screen_y, screen_x + 1, ' ');
     }
 
-    mvaddch(y + 1, FIELD_WIDTH * 2 + 1, '|');
+    mvaddch(row + 1, view_width * 2 + 1, '|');
+  }
+
+  mvaddch(view_height + 1, 0, '+');
+  for (int x = 0; x < view_width * 2; x++)
+  {
+    mvaddch(view_height + 1, x + 1, '-');
+  }
+  mvaddch(view_height + 1, view_width * 2 + 1, '+');
+}
+
+void world_init(World *world, uint64_t seed)
+{
+  world_free(world);
+  world->seed = seed;
+  world->capacity = 64;
+  world->chunks = calloc(world->capacity, sizeof(Chunk *));
+  world->cursor = (vec2l){0, 0};
+  world->view = (vec2l){0, 0};
+  world->game_over = false;
+  world->cells_revealed = 0;
+  world->flags_placed = 0;
+}
+
+void world_free(World *world)
+{
+  for (size_t i = 0; i < world->capacity; i++)
+    free(world->chunks[i]);
+  free(world->chunks);
+  free(world->flood);
+  world->chunks = NULL;
+  world->flood = NULL;
+  world->capacity = 0;
+  world->count = 0;
+  world->flood_capacity = 0;
+}
+
+Chunk *world_chunk(World *world, int64_t cx, int64_t cy, bool create)
+{
+  size_t mask = world->capacity - 1;
+  size_t i = chunk_hash(cx, cy) & mask;
+  while (world->chunks[i] != NULL)
+  {
+    if (world->chunks[i]->cx == cx && world->chunks[i]->cy == cy)
+      return world->chunks[i];
+    i = (i + 1) & mask;
+  }
+
+  if (!create)
+    return NULL;
+
+  if ((world->count + 1) * 2 > world->capacity)
+  {
+    Chunk **old = world->chunks;
+    size_t old_capacity = world->capacity;
+    world->capacity *= 2;
+    world->chunks = calloc(world->capacity, sizeof(Chunk *));
+    mask = world->capacity - 1;
+    for (size_t j = 0; j < old_capacity; j++)
+    {
+      if (old[j] == NULL)
+        continue;
+      size_t k = chunk_hash(old[j]->cx, old[j]->cy) & mask;
+      while (world->chunks[k] != NULL)
+        k = (k + 1) & mask;
+      world->chunks[k] = old[j];
+    }
+    free(old);
+
+    i = chunk_hash(cx, cy) & mask;
+    while (world->chunks[i] != NULL)
+      i = (i + 1) & mask;
+  }
+
+  Chunk *chunk = calloc(1, sizeof(Chunk));
+  chunk->cx = cx;
+  chunk->cy = cy;
+  chunk_bombs(world->seed, cx, cy, chunk->bombs);
+  chunk_adjacent(world, chunk);
+  world->chunks[i] = chunk;
+  world->count++;
+  return chunk;
+}
+
+void chunk_bombs(uint64_t seed, int64_t cx, int64_t cy, uint64_t bombs[CHUNK_SIZE])
+{
+  uint64_t rng = seed ^ chunk_hash(cx, cy);
+  for (int row = 0; row < CHUNK_SIZE; row++)
+    bombs[row] = random_bombs(&rng);
+}
+
+void chunk_adjacent(World *world, Chunk *chunk)
+{
+  uint64_t around[3][3][CHUNK_SIZE];
+  for (int dy = -1; dy <= 1; dy++)
+  {
+    for (int dx = -1; dx <= 1; dx++)
+    {
+      if (dx == 0 && dy == 0)
+        memcpy(around[1][1], chunk->bombs, sizeof(chunk->bombs));
+      else
+        chunk_bombs(world->seed, chunk->cx + dx, chunk->cy + dy, around[dy + 1][dx + 1]);
+    }
+  }
+
+  for (int row = 0; row < CHUNK_SIZE; row++)
+  {
+    uint64_t east[3], center[3], west[3];
+    for (int i = 0; i < 3; i++)
+    {
+      int r = row + i - 1;
+      int band = r < 0 ? 0 : (r >= CHUNK_SIZE ? 2 : 1);
+      r = (r + CHUNK_SIZE) % CHUNK_SIZE;
+      center[i] = around[band][1][r];
+      east[i] = (center[i] << 1) | (around[band][0][r] >> 63);
+      west[i] = (center[i] >> 1) | (around[band][2][r] << 63);
+    }
+
+    uint64_t s1, c1, s2, c2, s3, c3, s4, c4, b0, b1, b2, b3;
+    full_add(east[0], center[0], west[0], &s1, &c1);
+    full_add(east[2], center[2], west[2], &s2, &c2);
+    full_add(s1, s2, east[1], &s3, &c3);
+    full_add(s3, west[1], 0, &b0, &c4);
+    full_add(c1, c2, c3, &s4, &b2);
+    full_add(s4, c4, 0, &b1, &b3);
+
+    chunk->adjacent[0][row] = b0;
+    chunk->adjacent[1][row] = b1;
+    chunk->adjacent[2][row] = b2 ^ b3;
+    chunk->adjacent[3][row] = b2 & b3;
+  }
+}
+
+void world_push(World *world, int64_t x, int64_t y)
+{
+  if (world->flood_count == world->flood_capacity)
+  {
+    world->flood_capacity = world->flood_capacity == 0 ? 1024 : world->flood_capacity * 2;
+    world->flood = realloc(world->flood, world->flood_capacity * sizeof(vec2l));
   }
+  world->flood[world->flood_count++] = (vec2l){x, y};
+}
+
+void world_reveal(World *world, int64_t x, int64_t y)
+{
+  world->flood_count = 0;
+  world_push(world, x, y);
 
-  mvaddch(FIELD_HEIGHT + 1, 0, '*');
-  for (int x = 0; x < FIELD_WIDTH * 2; x++)
+  while (world->flood_count > 0)
   {
-    mvaddch(FIELD_HEIGHT + 1, x + 1, '-');
+    vec2l cell = world->flood[--world->flood_count];
+    Chunk *chunk = world_chunk(world, chunk_coord(cell.x), chunk_coord(cell.y), true);
+    int col = cell.x - chunk->cx * CHUNK_SIZE;
+    int row = cell.y - chunk->cy * CHUNK_SIZE;
+    uint64_t bit = 1ULL << col;
+
+    if ((chunk->revealed[row] | chunk->marked[row]) & bit)
+      continue;
+
+    chunk->revealed[row] |= bit;
+    world->cells_revealed++;
+
+    if (chunk->bombs[row] & bit)
+    {
+      world->game_over = true;
+      continue;
+    }
+
+    if ((chunk->adjacent[0][row] | chunk->adjacent[1][row] | chunk->adjacent[2][row] | chunk->adjacent[3][row]) & bit)
+      continue;
+
+    for (int dy = -1; dy <= 1; dy++)
+    {
+      for (int dx = -1; dx <= 1; dx++)
+      {
+        if (dx != 0 || dy != 0)
+          world_push(world, cell.x + dx, cell.y + dy);
+      }
+    }
   }
-  mvaddch(FIELD_HEIGHT + 1, FIELD_WIDTH * 2 + 1, '+');
+}
+
+bool world_save(World *world, const char *path)
+{
+  FILE *file = fopen(path, "wb");
+  if (file == NULL)
+    return false;
 
-  if (state->game_over && !state->won)
+  uint64_t stored = 0;
+  for (size_t i = 0; i < world->capacity; i++)
   {
-    for (int x = 0; x < FIELD_WIDTH; x++)
+    Chunk *chunk = world->chunks[i];
+    for (int row = 0; chunk != NULL && row < CHUNK_SIZE; row++)
     {
-      for (int y = 0; y < FIELD_HEIGHT; y++)
+      if (chunk->revealed[row] | chunk->marked[row])
       {
-        if (state->field[x][y].has_bomb)
-        {
-          attron(A_BOLD);
-          mvaddch(y + 1, x * 2 + 1, '*');
-          attroff(A_BOLD);
-        }
+        stored++;
+        break;
       }
     }
   }
+
+  int64_t header[5] = {(int64_t)world->seed, world->cursor.x, world->cursor.y, world->cells_revealed, world->flags_placed};
+  fwrite(WORLD_MAGIC, 1, 8, file);
+  fwrite(header, sizeof(header), 1, file);
+  fwrite(&stored, sizeof(stored), 1, file);
+
+  for (size_t i = 0; i < world->capacity; i++)
+  {
+    Chunk *chunk = world->chunks[i];
+    bool touched = false;
+    for (int row = 0; chunk != NULL && row < CHUNK_SIZE && !touched; row++)
+      touched = (chunk->revealed[row] | chunk->marked[row]) != 0;
+    if (!touched)
+      continue;
+
+    uint64_t rows[2] = {0, 0};
+    for (int row = 0; row < CHUNK_SIZE; row++)
+    {
+      rows[0] |= (uint64_t)(chunk->revealed[row] != 0) << row;
+      rows[1] |= (uint64_t)(chunk->marked[row] != 0) << row;
+    }
+
+    fwrite(&chunk->cx, sizeof(chunk->cx), 1, file);
+    fwrite(&chunk->cy, sizeof(chunk->cy), 1, file);
+    fwrite(rows, sizeof(rows), 1, file);
+    for (int row = 0; row < CHUNK_SIZE; row++)
+    {
+      if ((rows[0] >> row) & 1)
+        fwrite(&chunk->revealed[row], sizeof(uint64_t), 1, file);
+    }
+    for (int row = 0; row < CHUNK_SIZE; row++)
+    {
+      if ((rows[1] >> row) & 1)
+        fwrite(&chunk->marked[row], sizeof(uint64_t), 1, file);
+    }
+  }
+
+  return fclose(file) == 0;
+}
+
+bool world_load(World *world, const char *path)
+{
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+    return false;
+
+  char magic[8];
+  int64_t header[5];
+  uint64_t stored;
+  if (fread(magic, 1, 8, file) != 8 || memcmp(magic, WORLD_MAGIC, 8) != 0 ||
+      fread(header, sizeof(header), 1, file) != 1 || fread(&stored, sizeof(stored), 1, file) != 1)
+  {
+    fclose(file);
+    return false;
+  }
+
+  world_init(world, (uint64_t)header[0]);
+  world->cursor = (vec2l){header[1], header[2]};
+  world->cells_revealed = header[3];
+  world->flags_placed = header[4];
+
+  for (uint64_t i = 0; i < stored; i++)
+  {
+    int64_t cx, cy;
+    uint64_t rows[2];
+    bool valid = fread(&cx, sizeof(cx), 1, file) == 1 && fread(&cy, sizeof(cy), 1, file) == 1 &&
+                 fread(rows, sizeof(rows), 1, file) == 1;
+
+    Chunk *chunk = valid ? world_chunk(world, cx, cy, true) : NULL;
+    for (int row = 0; row < CHUNK_SIZE && valid; row++)
+    {
+      if ((rows[0] >> row) & 1)
+        valid = fread(&chunk->revealed[row], sizeof(uint64_t), 1, file) == 1;
+    }
+    for (int row = 0; row < CHUNK_SIZE && valid; row++)
+    {
+      if ((rows[1] >> row) & 1)
+        valid = fread(&chunk->marked[row], sizeof(uint64_t), 1, file) == 1;
+    }
+
+    if (!valid)
+    {
+      fclose(file);
+      world_free(world);
+      return false;
+    }
+  }
+
+  fclose(file);
+  return true;
+}
+
+void endless_loop(World *world, WINDOW *win)
+{
+  while (!world->game_over)
+  {
+    world_handle_input(world, win);
+
+    erase();
+    draw_world(world);
+
+    int view_height = LINES - 5;
+    mvprintw(view_height + 2, 0, "Posição: %lld,%lld | Bandeiras: %ld | Reveladas: %ld | Blocos: %zu",
+             (long long)world->cursor.x, (long long)world->cursor.y, world->flags_placed,
+             world->cells_revealed, world->count);
+    mvprintw(view_height + 3, 0, "ENTER: Revelar | ESPAÇO: Marcar | S: Salvar | ESC: Sair");
+
+    refresh();
+    usleep(50000);
+  }
+}
+
+void world_handle_input(World *world, WINDOW *win)
+{
+  int pressed = wgetch(win);
+
+  if (pressed == KEY_UP)
+  {
+    world->cursor.y--;
+  }
+  else if (pressed == KEY_DOWN)
+  {
+    world->cursor.y++;
+  }
+  else if (pressed == KEY_RIGHT)
+  {
+    world->cursor.x++;
+  }
+  else if (pressed == KEY_LEFT)
+  {
+    world->cursor.x--;
+  }
+  else if (pressed == '\n' || pressed == KEY_ENTER)
+  {
+    world_reveal(world, world->cursor.x, world->cursor.y);
+  }
+  else if (pressed == ' ')
+  {
+    Chunk *chunk = world_chunk(world, chunk_coord(world->cursor.x), chunk_coord(world->cursor.y), true);
+    int row = world->cursor.y - chunk->cy * CHUNK_SIZE;
+    uint64_t bit = 1ULL << (world->cursor.x - chunk->cx * CHUNK_SIZE);
+    if (!(chunk->revealed[row] & bit))
+    {
+      chunk->marked[row] ^= bit;
+      world->flags_placed += chunk->marked[row] & bit ? 1 : -1;
+    }
+  }
+  else if (pressed == 's' || pressed == 'S')
+  {
+    world_save(world, WORLD_PATH);
+  }
+  else if (pressed == 27)
+  {
+    endwin();
+    exit(0);
+  }
+}
+
+void draw_world(World *world)
+{
+  int view_width = (COLS - 2) / 2 > 1 ? (COLS - 2) / 2 : 1;
+  int view_height = LINES - 5 > 1 ? LINES - 5 : 1;
+
+  if (world->cursor.x < world->view.x)
+    world->view.x = world->cursor.x;
+  else if (world->cursor.x >= world->view.x + view_width)
+    world->view.x = world->cursor.x - view_width + 1;
+  if (world->cursor.y < world->view.y)
+    world->view.y = world->cursor.y;
+  else if (world->cursor.y >= world->view.y + view_height)
+    world->view.y = world->cursor.y - view_height + 1;
+
+  for (int row = 0; row < view_height; row++)
+  {
+    int64_t y = world->view.y + row;
+    int64_t cy = chunk_coord(y);
+    int r = y - cy * CHUNK_SIZE;
+    Chunk *chunk = NULL;
+    int64_t cx = INT64_MIN;
+
+    for (int col = 0; col < view_width; col++)
+    {
+      int64_t x = world->view.x + col;
+      if (chunk_coord(x) != cx)
+      {
+        cx = chunk_coord(x);
+        chunk = world_chunk(world, cx, cy, false);
+      }
+
+      uint64_t bit = 1ULL << (x - cx * CHUNK_SIZE);
+      int screen_x = col * 2 + 1;
+      int screen_y = row + 1;
+
+      if (world->cursor.x == x && world->cursor.y == y)
+      {
+        attron(A_REVERSE);
+      }
+
+      if (chunk != NULL && (chunk->revealed[r] & bit))
+      {
+        int adjacent = 0;
+        for (int i = 0; i < 4; i++)
+          adjacent |= ((chunk->adjacent[i][r] & bit) != 0) << i;
+
+        if (chunk->bombs[r] & bit)
+        {
+          attron(A_BOLD);
+          mvaddch(screen_y, screen_x, '*');
+          attroff(A_BOLD);
+        }
+        else if (adjacent > 0)
+        {
+          mvprintw(screen_y, screen_x, "%d", adjacent);
+        }
+        else
+        {
+          mvaddch(screen_y, screen_x, ' ');
+        }
+      }
+      else if (chunk != NULL && (chunk->marked[r] & bit))
+      {
+        attron(A_BOLD);
+        mvaddch(screen_y, screen_x, 'F');
+        attroff(A_BOLD);
+      }
+      else
+      {
+        mvaddch(screen_y, screen_x, '#');
+      }
+
+      attroff(A_REVERSE);
+    }
+  }
+}
+
+void solver_init(Solver *solver, int width, int height)
+{
+  solver_free(solver);
+  size_t cells = (size_t)width * height;
+  solver->width = width;
+  solver->height = height;
+  solver->status = malloc(cells);
+  solver->numbers = malloc(cells);
+  solver->constraints = malloc(cells * sizeof(Constraint));
+  solver->constraint_at = malloc(cells * sizeof(int));
+  solver->links = malloc(cells * sizeof(*solver->links));
+  solver->link_count = malloc(cells);
+  solver->local = malloc(cells * sizeof(int));
+  solver->position = malloc(cells * sizeof(int));
+  solver->order = malloc(cells * sizeof(int));
+  solver->probability = malloc(cells * sizeof(double));
+  solver->safe = malloc(cells * sizeof(int));
+  solver->mines = malloc(cells * sizeof(int));
+}
+
+void solver_free(Solver *solver)
+{
+  free(solver->status);
+  free(solver->numbers);
+  free(solver->constraints);
+  free(solver->constraint_at);
+  free(solver->links);
+  free(solver->link_count);
+  free(solver->local);
+  free(solver->position);
+  free(solver->order);
+  free(solver->probability);
+  free(solver->safe);
+  free(solver->mines);
+  bool parallel = solver->parallel;
+  bool logic_only = solver->logic_only;
+  memset(solver, 0, sizeof(*solver));
+  solver->parallel = parallel;
+  solver->logic_only = logic_only;
+}
+
+void solver_mark(Solver *solver, int cell, int status)
+{
+  if (solver->status[cell] != SOLVER_UNKNOWN)
+    return;
+
+  solver->status[cell] = status;
+  if (status == SOLVER_SAFE)
+    solver->safe[solver->safe_count++] = cell;
+  else
+    solver->mines[solver->mine_count++] = cell;
+}
+
+void solver_compact(Solver *solver, Constraint *constraint)
+{
+  int count = 0;
+  for (int i = 0; i < constraint->count; i++)
+  {
+    int cell = constraint->vars[i];
+    if (solver->status[cell] == SOLVER_MINE)
+      constraint->need--;
+    else if (solver->status[cell] == SOLVER_UNKNOWN)
+      constraint->vars[count++] = cell;
+  }
+  constraint->count = count;
+}
+
+bool solver_rules(Solver *solver)
+{
+  bool progress = false;
+  for (int i = 0; i < solver->constraint_count; i++)
+  {
+    Constraint *constraint = &solver->constraints[i];
+    solver_compact(solver, constraint);
+    if (constraint->count == 0)
+      continue;
+
+    if (constraint->need == 0 || constraint->need == constraint->count)
+    {
+      int status = constraint->need == 0 ? SOLVER_SAFE : SOLVER_MINE;
+      for (int j = 0; j < constraint->count; j++)
+        solver_mark(solver, constraint->vars[j], status);
+      constraint->count = 0;
+      progress = true;
+    }
+  }
+  if (progress)
+    return true;
+
+  for (int i = 0; i < solver->constraint_count; i++)
+  {
+    Constraint *a = &solver->constraints[i];
+    solver_compact(solver, a);
+    if (a->count == 0)
+      continue;
+
+    int ax = a->cell % solver->width;
+    int ay = a->cell / solver->width;
+    for (int y = ay - 2; y <= ay + 2; y++)
+    {
+      for (int x = ax - 2; x <= ax + 2; x++)
+      {
+        if (x < 0 || x >= solver->width || y < 0 || y >= solver->height)
+          continue;
+        int other = solver->constraint_at[y * solver->width + x];
+        if (other < 0 || other == i)
+          continue;
+
+        Constraint *b = &solver->constraints[other];
+        solver_compact(solver, b);
+        if (b->count <= a->count)
+          continue;
+
+        int diff[8];
+        int diff_count = 0;
+        int shared = 0;
+        for (int j = 0; j < b->count; j++)
+        {
+          bool inside = false;
+          for (int k = 0; k < a->count && !inside; k++)
+            inside = a->vars[k] == b->vars[j];
+          if (inside)
+            shared++;
+          else
+            diff[diff_count++] = b->vars[j];
+        }
+        if (shared != a->count)
+          continue;
+
+        int need = b->need - a->need;
+        if (need != 0 && need != diff_count)
+          continue;
+
+        for (int j = 0; j < diff_count; j++)
+          solver_mark(solver, diff[j], need == 0 ? SOLVER_SAFE : SOLVER_MINE);
+        progress = true;
+      }
+    }
+  }
+  return progress;
+}
+
+void enumerate_component(Component *comp, int depth, int mines)
+{
+  if (comp->exhausted)
+    return;
+  if (++comp->nodes > SOLVER_NODE_BUDGET)
+  {
+    comp->exhausted = true;
+    return;
+  }
+
+  if (depth == comp->size)
+  {
+    comp->totals[mines] += 1;
+    double *row = comp->mines + (size_t)mines * comp->size;
+    for (int i = 0; i < mines; i++)
+      row[comp->stack[i]] += 1;
+    return;
+  }
+
+  int cell = comp->cells[depth];
+  int links = comp->link_count[cell];
+  for (int value = 0; value <= 1; value++)
+  {
+    bool fits = true;
+    for (int i = 0; i < links && fits; i++)
+    {
+      int c = comp->local[comp->links[cell][i]];
+      int assigned = comp->assigned[c] + value;
+      fits = assigned <= comp->need[c] && assigned + comp->remaining[c] - 1 >= comp->need[c];
+    }
+    if (!fits)
+      continue;
+
+    for (int i = 0; i < links; i++)
+    {
+      int c = comp->local[comp->links[cell][i]];
+      comp->assigned[c] += value;
+      comp->remaining[c]--;
+    }
+    if (value)
+      comp->stack[mines] = depth;
+
+    enumerate_component(comp, depth + 1, mines + value);
+
+    for (int i = 0; i < links; i++)
+    {
+      int c = comp->local[comp->links[cell][i]];
+      comp->assigned[c] -= value;
+      comp->remaining[c]++;
+    }
+  }
+}
+
+void *solver_worker(void *arg)
+{
+  (void)arg;
+  int seen = 0;
+
+  pthread_mutex_lock(&solver_pool.lock);
+  while (true)
+  {
+    while (solver_pool.job == seen)
+      pthread_cond_wait(&solver_pool.wake, &solver_pool.lock);
+    seen = solver_pool.job;
+    SolverQueue *queue = solver_pool.queue;
+    pthread_mutex_unlock(&solver_pool.lock);
+
+    solver_drain(queue);
+
+    pthread_mutex_lock(&solver_pool.lock);
+    if (--solver_pool.active == 0)
+      pthread_cond_signal(&solver_pool.done);
+  }
+  return NULL;
+}
+
+void solver_drain(SolverQueue *queue)
+{
+  int next;
+  while ((next = atomic_fetch_add(&queue->next, 1)) < queue->count)
+    enumerate_component(queue->components[next], 0, 0);
+}
+
+void convolve(const double *a, int a_size, const double *b, int b_size, double *out)
+{
+  for (int i = 0; i <= a_size + b_size; i++)
+    out[i] = 0;
+  for (int i = 0; i <= a_size; i++)
+  {
+    for (int j = 0; j <= b_size; j++)
+      out[i + j] += a[i] * b[j];
+  }
+}
+
+void solver_probabilities(Solver *solver, GameState *state)
+{
+  int cells = solver->width * solver->height;
+  for (int cell = 0; cell < cells; cell++)
+  {
+    solver->link_count[cell] = 0;
+    solver->position[cell] = -1;
+  }
+  for (int i = 0; i < solver->constraint_count; i++)
+  {
+    Constraint *constraint = &solver->constraints[i];
+    solver_compact(solver, constraint);
+    solver->local[i] = -1;
+    for (int j = 0; j < constraint->count; j++)
+    {
+      int cell = constraint->vars[j];
+      solver->links[cell][solver->link_count[cell]++] = i;
+    }
+  }
+
+  int comp_count = 0;
+  int frontier = 0;
+  Component *comps = NULL;
+  for (int start = 0; start < cells; start++)
+  {
+    if (solver->link_count[start] == 0 || solver->position[start] >= 0)
+      continue;
+
+    Component comp;
+    memset(&comp, 0, sizeof(comp));
+    comp.constraints = solver->constraints;
+    comp.links = (const int (*)[8])solver->links;
+    comp.link_count = solver->link_count;
+    comp.local = solver->local;
+    comp.cells = solver->order + frontier;
+
+    comp.cells[comp.size++] = start;
+    solver->position[start] = 0;
+    for (int head = 0; head < comp.size; head++)
+    {
+      int cell = comp.cells[head];
+      for (int i = 0; i < solver->link_count[cell]; i++)
+      {
+        int c = solver->links[cell][i];
+        if (solver->local[c] < 0)
+          solver->local[c] = comp.members++;
+        Constraint *constraint = &solver->constraints[c];
+        for (int j = 0; j < constraint->count; j++)
+        {
+          int var = constraint->vars[j];
+          if (solver->position[var] < 0)
+          {
+            solver->position[var] = comp.size;
+            comp.cells[comp.size++] = var;
+          }
+        }
+      }
+    }
+    frontier += comp.size;
+
+    comp.need = malloc(comp.members * sizeof(int));
+    comp.assigned = calloc(comp.members, sizeof(int));
+    comp.remaining = malloc(comp.members * sizeof(int));
+    comp.stack = malloc(comp.size * sizeof(int));
+    comp.totals = calloc(comp.size + 1, sizeof(double));
+    comp.mines = calloc((size_t)(comp.size + 1) * comp.size, sizeof(double));
+    for (int head = 0; head < comp.size; head++)
+    {
+      int cell = comp.cells[head];
+      for (int i = 0; i < solver->link_count[cell]; i++)
+      {
+        Constraint *constraint = &solver->constraints[solver->links[cell][i]];
+        int c = solver->local[solver->links[cell][i]];
+        comp.need[c] = constraint->need;
+        comp.remaining[c] = constraint->count;
+      }
+    }
+
+    comps = realloc(comps, (comp_count + 1) * sizeof(Component));
+    comps[comp_count++] = comp;
+  }
+
+  Component *large[SOLVER_MAX_THREADS * 4];
+  SolverQueue queue = {.components = large, .count = 0};
+  for (int i = 0; i < comp_count; i++)
+  {
+    if (solver->parallel && comps[i].size >= SOLVER_PARALLEL_CELLS && queue.count < SOLVER_MAX_THREADS * 4)
+      large[queue.count++] = &comps[i];
+    else
+      enumerate_component(&comps[i], 0, 0);
+  }
+
+  if (queue.count > 0)
+  {
+    atomic_init(&queue.next, 0);
+    pthread_mutex_lock(&solver_pool.lock);
+    if (!solver_pool.started)
+    {
+      long threads = sysconf(_SC_NPROCESSORS_ONLN);
+      if (threads > SOLVER_MAX_THREADS)
+        threads = SOLVER_MAX_THREADS;
+      for (long i = 1; i < threads; i++)
+        pthread_create(&solver_pool.threads[solver_pool.thread_count++], NULL, solver_worker, NULL);
+      solver_pool.started = true;
+    }
+
+    int helpers = queue.count - 1 < solver_pool.thread_count ? queue.count - 1 : solver_pool.thread_count;
+    if (helpers > 0)
+    {
+      solver_pool.queue = &queue;
+      solver_pool.active = solver_pool.thread_count;
+      solver_pool.job++;
+      pthread_cond_broadcast(&solver_pool.wake);
+    }
+    pthread_mutex_unlock(&solver_pool.lock);
+
+    solver_drain(&queue);
+
+    if (helpers > 0)
+    {
+      pthread_mutex_lock(&solver_pool.lock);
+      while (solver_pool.active > 0)
+        pthread_cond_wait(&solver_pool.done, &solver_pool.lock);
+      pthread_mutex_unlock(&solver_pool.lock);
+    }
+  }
+
+  int unknown = 0;
+  int known_mines = 0;
+  for (int cell = 0; cell < cells; cell++)
+  {
+    unknown += solver->status[cell] == SOLVER_UNKNOWN;
+    known_mines += solver->status[cell] == SOLVER_MINE;
+  }
+
+  solver->exact = true;
+  int span = 0;
+  for (int i = 0; i < comp_count; i++)
+  {
+    solver->nodes += comps[i].nodes;
+    if (comps[i].exhausted)
+    {
+      solver->exact = false;
+      continue;
+    }
+    unknown -= comps[i].size;
+    span += comps[i].size;
+
+    double scale = 0;
+    for (int k = 0; k <= comps[i].size; k++)
+      scale = comps[i].totals[k] > scale ? comps[i].totals[k] : scale;
+    for (int k = 0; k <= comps[i].size && scale > 0; k++)
+    {
+      comps[i].totals[k] /= scale;
+      for (int j = 0; j < comps[i].size; j++)
+        comps[i].mines[(size_t)k * comps[i].size + j] /= scale;
+    }
+  }
+
+  int interior = unknown;
+  long remaining = state->bombs_total - known_mines;
+
+  double *weights = calloc(span + 1, sizeof(double));
+  double best = -INFINITY;
+  for (int k = 0; k <= span; k++)
+  {
+    long left = remaining - k;
+    if (left >= 0 && left <= interior)
+    {
+      double log_weight = lgamma(interior + 1.0) - lgamma(left + 1.0) - lgamma(interior - left + 1.0);
+      weights[k] = log_weight;
+      best = log_weight > best ? log_weight : best;
+    }
+    else
+    {
+      weights[k] = -INFINITY;
+    }
+  }
+  for (int k = 0; k <= span; k++)
+    weights[k] = weights[k] == -INFINITY ? 0 : exp(weights[k] - best);
+
+  double *prefix = malloc((size_t)(comp_count + 1) * (span + 1) * sizeof(double));
+  double *suffix = malloc((size_t)(comp_count + 1) * (span + 1) * sizeof(double));
+  double *others = malloc((span + 1) * sizeof(double));
+  int *prefix_size = calloc(comp_count + 1, sizeof(int));
+  int *suffix_size = calloc(comp_count + 1, sizeof(int));
+  prefix[0] = 1;
+  suffix[(size_t)comp_count * (span + 1)] = 1;
+  for (int i = 0; i < comp_count; i++)
+  {
+    int size = comps[i].exhausted ? 0 : comps[i].size;
+    const double *totals = comps[i].exhausted ? (const double[]){1} : comps[i].totals;
+    convolve(prefix + (size_t)i * (span + 1), prefix_size[i], totals, size, prefix + (size_t)(i + 1) * (span + 1));
+    prefix_size[i + 1] = prefix_size[i] + size;
+  }
+  for (int i = comp_count - 1; i >= 0; i--)
+  {
+    int size = comps[i].exhausted ? 0 : comps[i].size;
+    const double *totals = comps[i].exhausted ? (const double[]){1} : comps[i].totals;
+    convolve(suffix + (size_t)(i + 1) * (span + 1), suffix_size[i + 1], totals, size, suffix + (size_t)i * (span + 1));
+    suffix_size[i] = suffix_size[i + 1] + size;
+  }
+
+  const double *all = prefix + (size_t)comp_count * (span + 1);
+  double total = 0;
+  double interior_mines = 0;
+  for (int k = 0; k <= span; k++)
+  {
+    total += all[k] * weights[k];
+    if (interior > 0)
+      interior_mines += all[k] * weights[k] * (remaining - k) / interior;
+  }
+
+  double density = unknown + span > 0 ? (double)remaining / (unknown + span) : 0;
+  double interior_probability = total > 0 ? interior_mines / total : density;
+  for (int cell = 0; cell < cells; cell++)
+    solver->probability[cell] = solver->status[cell] == SOLVER_UNKNOWN ? interior_probability : (solver->status[cell] == SOLVER_MINE);
+
+  for (int i = 0; i < comp_count; i++)
+  {
+    Component *comp = &comps[i];
+    if (!comp->exhausted && total > 0)
+    {
+      int others_size = prefix_size[i] + suffix_size[i + 1];
+      convolve(prefix + (size_t)i * (span + 1), prefix_size[i], suffix + (size_t)(i + 1) * (span + 1), suffix_size[i + 1], others);
+
+      for (int k = 0; k <= comp->size; k++)
+      {
+        double weight = 0;
+        for (int j = 0; j <= others_size; j++)
+          weight += others[j] * weights[k + j];
+        comp->totals[k] = weight;
+      }
+      for (int j = 0; j < comp->size; j++)
+      {
+        double mines = 0;
+        for (int k = 0; k <= comp->size; k++)
+          mines += comp->mines[(size_t)k * comp->size + j] * comp->totals[k];
+        solver->probability[comp->cells[j]] = mines / total;
+      }
+    }
+    else if (comp->exhausted)
+    {
+      for (int j = 0; j < comp->size; j++)
+        solver->probability[comp->cells[j]] = interior_probability;
+    }
+
+    free(comp->need);
+    free(comp->assigned);
+    free(comp->remaining);
+    free(comp->stack);
+    free(comp->totals);
+    free(comp->mines);
+  }
+
+  free(comps);
+  free(weights);
+  free(prefix);
+  free(suffix);
+  free(others);
+  free(prefix_size);
+  free(suffix_size);
+}
+
+bool solver_analyze(Solver *solver, GameState *state)
+{
+  if (solver->status == NULL || solver->width != state->width || solver->height != state->height)
+    solver_init(solver, state->width, state->height);
+
+  int width = state->width;
+  int height = state->height;
+  solver->safe_count = 0;
+  solver->mine_count = 0;
+  solver->constraint_count = 0;
+  solver->guess = -1;
+  solver->guess_probability = 1;
+  solver->exact = true;
+
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      int cell = y * width + x;
+      bool open = get_bit(state, state->revealed, x, y);
+      solver->status[cell] = open ? SOLVER_OPEN : SOLVER_UNKNOWN;
+      solver->numbers[cell] = open ? count_adjacent_bombs(state, x, y) : 0;
+      solver->constraint_at[cell] = -1;
+    }
+  }
+
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      int cell = y * width + x;
+      if (solver->status[cell] != SOLVER_OPEN)
+        continue;
+
+      Constraint *constraint = &solver->constraints[solver->constraint_count];
+      constraint->cell = cell;
+      constraint->need = solver->numbers[cell];
+      constraint->count = 0;
+      for (int ny = y - 1; ny <= y + 1; ny++)
+      {
+        for (int nx = x - 1; nx <= x + 1; nx++)
+        {
+          if (nx >= 0 && nx < width && ny >= 0 && ny < height && solver->status[ny * width + nx] == SOLVER_UNKNOWN)
+            constraint->vars[constraint->count++] = ny * width + nx;
+        }
+      }
+      if (constraint->count > 0)
+        solver->constraint_at[cell] = solver->constraint_count++;
+    }
+  }
+
+  while (solver_rules(solver))
+    ;
+  if (solver->safe_count > 0 || solver->logic_only)
+    return solver->safe_count > 0;
+
+  solver_probabilities(solver, state);
+
+  for (int cell = 0; cell < width * height; cell++)
+  {
+    if (solver->status[cell] != SOLVER_UNKNOWN)
+      continue;
+
+    double probability = solver->probability[cell];
+    if (solver->exact && probability < SOLVER_EPSILON)
+      solver_mark(solver, cell, SOLVER_SAFE);
+    else if (solver->exact && probability > 1 - SOLVER_EPSILON)
+      solver_mark(solver, cell, SOLVER_MINE);
+    else if (probability < solver->guess_probability)
+    {
+      solver->guess = cell;
+      solver->guess_probability = probability;
+    }
+  }
+
+  return solver->safe_count > 0 || solver->guess >= 0;
+}
+
+void give_hint(GameState *state)
+{
+  Solver *solver = &state->solver;
+  if (!solver_analyze(solver, state))
+  {
+    snprintf(state->message, sizeof(state->message), "Nenhuma dica disponível");
+    return;
+  }
+
+  if (solver->safe_count > 0)
+  {
+    int cell = solver->safe[0];
+    state->cursor = (vec2){cell % state->width, cell / state->width};
+    snprintf(state->message, sizeof(state->message), "Dica: coluna %d, linha %d é segura (%d seguras, %d minas)",
+             state->cursor.x + 1, state->cursor.y + 1, solver->safe_count, solver->mine_count);
+  }
+  else
+  {
+    int cell = solver->guess;
+    state->cursor = (vec2){cell % state->width, cell / state->width};
+    snprintf(state->message, sizeof(state->message), "Palpite: coluna %d, linha %d (%.0f%% de chance de mina)",
+             state->cursor.x + 1, state->cursor.y + 1, solver->guess_probability * 100);
+  }
+}
+
+// Draws the mines without replacement from the cells outside the 3x3
+// opening, so dense boards never retry and the count is capped at what fits.
+void place_mines(GameState *state, long count, int safe_x, int safe_y, uint64_t *rng)
+{
+  memset(state->bombs, 0, (size_t)state->stride * state->height * sizeof(uint64_t));
+  long eligible = 0;
+  for (int y = 0; y < state->height; y++)
+  {
+    for (int x = 0; x < state->width; x++)
+    {
+      if (abs(x - safe_x) > 1 || abs(y - safe_y) > 1)
+        state->candidates[eligible++] = y * state->width + x;
+    }
+  }
+
+  if (count > eligible)
+    count = eligible;
+  for (long placed = 0; placed < count; placed++)
+  {
+    long pick = placed + (long)((next_random(rng) >> 32) * (uint64_t)(eligible - placed) >> 32);
+    int cell = state->candidates[pick];
+    state->candidates[pick] = state->candidates[placed];
+    state->candidates[placed] = cell;
+    set_bit(state, state->bombs, cell % state->width, cell / state->width);
+  }
+  state->bombs_total = count;
+}
+
+long mine_capacity(GameState *state, int safe_x, int safe_y)
+{
+  int opening_w = (safe_x + 1 < state->width - 1 ? safe_x + 1 : state->width - 1) - (safe_x - 1 > 0 ? safe_x - 1 : 0) + 1;
+  int opening_h = (safe_y + 1 < state->height - 1 ? safe_y + 1 : state->height - 1) - (safe_y - 1 > 0 ? safe_y - 1 : 0) + 1;
+  return (long)state->width * state->height - (long)opening_w * opening_h;
+}
+
+bool logic_solvable(GameState *state, int x, int y)
+{
+  size_t bytes = (size_t)state->stride * state->height * sizeof(uint64_t);
+  memset(state->revealed, 0, bytes);
+  memset(state->marked, 0, bytes);
+  state->cells_revealed = 0;
+  state->game_over = false;
+
+  reveal_cell(state, x, y);
+  while (!check_win(state))
+  {
+    if (!solver_analyze(&state->solver, state))
+      return false;
+    for (int i = 0; i < state->solver.safe_count; i++)
+    {
+      int cell = state->solver.safe[i];
+      reveal_cell(state, cell % state->width, cell / state->width);
+    }
+  }
+  return !state->game_over;
+}
+
+void generate_no_guess(GameState *state, int x, int y)
+{
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  pthread_mutex_lock(&generator.lock);
+  if (generator.thread_count == 0)
+  {
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1)
+      threads = 1;
+    if (threads > GENERATOR_MAX_THREADS)
+      threads = GENERATOR_MAX_THREADS;
+    for (long i = 0; i < threads; i++)
+      pthread_create(&generator.threads[i], NULL, generator_worker, (void *)(intptr_t)i);
+    generator.thread_count = threads;
+  }
+
+  generator.width = state->width;
+  generator.height = state->height;
+  if (state->bombs_total > mine_capacity(state, x, y))
+    state->bombs_total = mine_capacity(state, x, y);
+  generator.mines = state->bombs_total;
+  generator.first = (vec2){x, y};
+  generator.seed = next_random(&state->rng);
+  generator.result = state->bombs;
+  atomic_store(&generator.found, false);
+  atomic_store(&generator.attempts, 0);
+  generator.active = generator.thread_count;
+  generator.job++;
+  pthread_cond_broadcast(&generator.wake);
+  while (generator.active > 0)
+    pthread_cond_wait(&generator.done, &generator.lock);
+  pthread_mutex_unlock(&generator.lock);
+
+  bool found = atomic_load(&generator.found);
+  if (!found)
+    place_mines(state, state->bombs_total, x, y, &state->rng);
+  calculate_adjacent_bombs(state);
+  state->pending = false;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+  snprintf(state->message, sizeof(state->message), "%s em %.1f ms (%ld tentativas)",
+           found ? "Tabuleiro sem chute gerado" : "Sem tabuleiro sem chute; gerado aleatório",
+           ms, atomic_load(&generator.attempts));
+}
+
+void *generator_worker(void *arg)
+{
+  int id = (int)(intptr_t)arg;
+  GameState scratch;
+  memset(&scratch, 0, sizeof(scratch));
+  scratch.solver.logic_only = true;
+  int seen = 0;
+
+  pthread_mutex_lock(&generator.lock);
+  while (true)
+  {
+    while (generator.job == seen)
+      pthread_cond_wait(&generator.wake, &generator.lock);
+    seen = generator.job;
+    int width = generator.width;
+    int height = generator.height;
+    long mines = generator.mines;
+    vec2 first = generator.first;
+    uint64_t rng = generator.seed ^ (0x9E3779B97F4A7C15ULL * (id + 1));
+    uint64_t *result = generator.result;
+    pthread_mutex_unlock(&generator.lock);
+
+    resize_game_state(&scratch, width, height);
+    while (!atomic_load(&generator.found) && atomic_fetch_add(&generator.attempts, 1) < GENERATOR_MAX_ATTEMPTS)
+    {
+      place_mines(&scratch, mines, first.x, first.y, &rng);
+      calculate_adjacent_bombs(&scratch);
+      if (logic_solvable(&scratch, first.x, first.y) && !atomic_exchange(&generator.found, true))
+        memcpy(result, scratch.bombs, (size_t)scratch.stride * height * sizeof(uint64_t));
+    }
+
+    pthread_mutex_lock(&generator.lock);
+    if (--generator.active == 0)
+      pthread_cond_signal(&generator.done);
+  }
+  return NULL;
+}
+
+double clock_ms(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e3 + now.tv_nsec / 1e6;
+}
+
+int run_simulation(long games, uint64_t seed)
+{
+  long threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads < 1)
+    threads = 1;
+  if (threads > GENERATOR_MAX_THREADS)
+    threads = GENERATOR_MAX_THREADS;
+
+  long total_games = 0;
+  long total_wins = 0;
+  double started = clock_ms();
+
+  for (size_t c = 0; c < sizeof(SIM_CONFIGS) / sizeof(SIM_CONFIGS[0]); c++)
+  {
+    const SimConfig *config = &SIM_CONFIGS[c];
+    SimJob job = {.config = config, .seed = seed ^ (0xD1B54A32D192ED03ULL * (c + 1)), .games = games};
+    atomic_init(&job.next, 0);
+
+    pthread_t workers[GENERATOR_MAX_THREADS];
+    SimWorker stats[GENERATOR_MAX_THREADS];
+    memset(stats, 0, sizeof(stats));
+    double start = clock_ms();
+    for (long i = 0; i < threads; i++)
+    {
+      stats[i].job = &job;
+      if (i > 0)
+        pthread_create(&workers[i], NULL, simulation_worker, &stats[i]);
+    }
+    simulation_worker(&stats[0]);
+    for (long i = 1; i < threads; i++)
+      pthread_join(workers[i], NULL);
+    double wall = clock_ms() - start;
+
+    SimWorker sum = {0};
+    for (long i = 0; i < threads; i++)
+    {
+      sum.wins += stats[i].wins;
+      sum.moves += stats[i].moves;
+      sum.guesses += stats[i].guesses;
+      sum.generate_ms += stats[i].generate_ms;
+      sum.reveal_ms += stats[i].reveal_ms;
+      sum.solve_ms += stats[i].solve_ms;
+    }
+    total_games += games;
+    total_wins += sum.wins;
+
+    printf("{\"bench\":\"simulate\",\"width\":%d,\"height\":%d,\"mines\":%ld,\"density\":%.3f,"
+           "\"games\":%ld,\"wins\":%ld,\"win_rate\":%.4f,\"games_per_second\":%.1f,\"threads\":%ld,"
+           "\"moves\":%ld,\"guesses\":%ld,\"generate_ms\":%.1f,\"reveal_ms\":%.1f,\"solve_ms\":%.1f}\n",
+           config->width, config->height, config->mines, (double)config->mines / (config->width * config->height),
+           games, sum.wins, games > 0 ? (double)sum.wins / games : 0.0, wall > 0 ? games / (wall / 1e3) : 0.0, threads,
+           sum.moves, sum.guesses, sum.generate_ms, sum.reveal_ms, sum.solve_ms);
+    fflush(stdout);
+  }
+
+  double wall = clock_ms() - started;
+  printf("{\"bench\":\"simulate-total\",\"games\":%ld,\"wins\":%ld,\"seconds\":%.3f,\"games_per_second\":%.1f}\n",
+         total_games, total_wins, wall / 1e3, wall > 0 ? total_games / (wall / 1e3) : 0.0);
+  return 0;
+}
+
+void *simulation_worker(void *arg)
+{
+  SimWorker *stats = arg;
+  SimJob *job = stats->job;
+  GameState state;
+  memset(&state, 0, sizeof(state));
+
+  long game;
+  while ((game = atomic_fetch_add(&job->next, 1)) < job->games)
+  {
+    uint64_t seed = job->seed + 0x9E3779B97F4A7C15ULL * game;
+    stats->wins += simulate_game(&state, job->config, next_random(&seed), stats);
+  }
+
+  free_game_state(&state);
+  return NULL;
+}
+
+bool simulate_game(GameState *state, const SimConfig *config, uint64_t seed, SimWorker *stats)
+{
+  double start = clock_ms();
+  resize_game_state(state, config->width, config->height);
+  size_t bytes = (size_t)state->stride * state->height * sizeof(uint64_t);
+  memset(state->revealed, 0, bytes);
+  memset(state->marked, 0, bytes);
+  state->cells_revealed = 0;
+  state->game_over = false;
+  state->rng = seed;
+  state->solver.safe_count = 0;
+  state->solver.mine_count = 0;
+
+  int x = config->width / 2;
+  int y = config->height / 2;
+  place_mines(state, config->mines, x, y, &state->rng);
+  calculate_adjacent_bombs(state);
+  double generated = clock_ms();
+  stats->generate_ms += generated - start;
+
+  while (true)
+  {
+    double before = clock_ms();
+    reveal_cell(state, x, y);
+    for (int i = 0; i < state->solver.safe_count; i++)
+    {
+      int cell = state->solver.safe[i];
+      reveal_cell(state, cell % state->width, cell / state->width);
+    }
+    double revealed = clock_ms();
+    stats->reveal_ms += revealed - before;
+
+    if (state->game_over || check_win(state))
+      return !state->game_over;
+
+    stats->moves++;
+    solver_analyze(&state->solver, state);
+    stats->solve_ms += clock_ms() - revealed;
+
+    if (state->solver.safe_count > 0)
+    {
+      int cell = state->solver.safe[--state->solver.safe_count];
+      x = cell % state->width;
+      y = cell / state->width;
+    }
+    else
+    {
+      stats->guesses++;
+      x = state->solver.guess % state->width;
+      y = state->solver.guess / state->width;
+    }
+  }
 }
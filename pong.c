@@ -1,4 +1,7 @@
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <curses.h>
 #include <time.h>
@@ -8,6 +11,27 @@
 #define SCREEN_HEIGHT 30
 #define PADDLE_HEIGHT 4
 #define BALL_SPEED 0.8f
+#define STEP_RATE 20
+#define TICK_RATE 240
+#define FRAME_RATE 60
+#define SERVE_TICKS (TICK_RATE / 2)
+#define MAX_FRAME_TICKS (TICK_RATE / 4)
+#define MAX_BOUNCES 8
+#define CHAOS_BALLS 500
+#define BENCH_TICKS (TICK_RATE * 10)
+#define BENCH_SEED 12345
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_CLONES __attribute__((target_clones("avx2", "sse4.1", "default")))
+#else
+#define SIMD_CLONES
+#endif
+
+typedef float lanes8 __attribute__((vector_size(32)));
+typedef int32_t mask8 __attribute__((vector_size(32)));
+
+// Lane-wise mask ? a : b; comparisons yield all-ones lanes for true.
+#define select8(mask, a, b) ((lanes8)(((mask) & (mask8)(a)) | (~(mask) & (mask8)(b))))
 
 typedef struct
 {
@@ -15,9 +39,12 @@ typedef struct
   float y;
 } vec2;
 
+// vel is in cells per STEP_RATE step; prev is the position one tick ago,
+// kept so frames can be drawn between ticks.
 typedef struct
 {
   vec2 pos;
+  vec2 prev;
   vec2 vel;
 } Ball;
 
@@ -27,26 +54,83 @@ typedef struct
   int height;
 } Paddle;
 
+typedef enum
+{
+  SURFACE_NONE,
+  SURFACE_TOP,
+  SURFACE_BOTTOM,
+  SURFACE_LEFT,
+  SURFACE_RIGHT
+} Surface;
+
+// Chaos mode balls as structure-of-arrays, padded to a multiple of 8 so the
+// physics runs eight balls per vector; serve counts ticks before a ball moves.
+typedef struct
+{
+  int count;
+  float *x;
+  float *y;
+  float *prev_x;
+  float *prev_y;
+  float *vel_x;
+  float *vel_y;
+  int32_t *serve;
+} BallSet;
+
 typedef struct
 {
   int score_left;
   int score_right;
   int balls_remaining;
+  int serve_ticks;
   Paddle player_left;
   Paddle player_right;
   Ball ball;
+  bool chaos;
+  BallSet balls;
 } GameState;
 
 void init_game_state(GameState *state);
 void game_loop(GameState *state, WINDOW *win);
+bool read_input(GameState *state, WINDOW *win);
+void move_paddle(Paddle *paddle, int dy);
+void step_physics(GameState *state);
+void draw_game(GameState *state, float alpha);
+void wait_for_frame(struct timespec *deadline);
+double elapsed_seconds(struct timespec *since);
 void dispatch_ball(GameState *state);
-void check_ball_collide(GameState *state);
+void sweep_ball(GameState *state, float dt);
+void earliest_hit(float *hit, Surface *surface, Surface candidate, float time);
+bool paddle_covers(Paddle *paddle, float y);
 void draw_box();
 void draw_players(GameState *state);
 void reset_ball(GameState *state);
+bool init_balls(BallSet *balls, int count);
+void free_balls(BallSet *balls);
+void serve_ball(BallSet *balls, int i);
+void move_balls(GameState *state, float dt);
+int run_bench(int argc, char *argv[]);
 
-int main(void)
+int main(int argc, char *argv[])
 {
+  GameState state = {0};
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--bench") == 0)
+      return run_bench(argc, argv);
+    if (strcmp(argv[i], "--chaos") == 0)
+    {
+      int count = i + 1 < argc && argv[i + 1][0] != '-' ? atoi(argv[++i]) : CHAOS_BALLS;
+      if (!init_balls(&state.balls, count))
+      {
+        fprintf(stderr, "Usage: %s [--chaos [BALLS]] [--bench [--ticks N] [--seed N]]\n", argv[0]);
+        return 1;
+      }
+      state.chaos = true;
+    }
+  }
+
   srand(time(NULL));
   WINDOW *win = initscr();
   keypad(win, true);
@@ -54,8 +138,6 @@ int main(void)
   curs_set(0);
   noecho();
 
-  GameState state;
-
   while (true)
   {
     init_game_state(&state);
@@ -76,6 +158,7 @@ int main(void)
       if (pressed == 27)
       {
         endwin();
+        free_balls(&state.balls);
         return 0;
       }
       if (pressed == '\n' || pressed == KEY_ENTER)
@@ -92,6 +175,7 @@ void init_game_state(GameState *state)
   state->score_left = 0;
   state->score_right = 0;
   state->balls_remaining = 5;
+  state->serve_ticks = 0;
 
   state->player_left = (Paddle){
       (vec2){2, SCREEN_HEIGHT / 2.0f},
@@ -101,91 +185,184 @@ void init_game_state(GameState *state)
       PADDLE_HEIGHT};
 
   state->ball = (Ball){
+      (vec2){SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f},
       (vec2){SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f},
       (vec2){0, 0}};
 
   dispatch_ball(state);
+
+  for (int i = 0; i < state->balls.count; i++)
+  {
+    serve_ball(&state->balls, i);
+  }
 }
 
+// Physics runs on fixed TICK_RATE ticks, independent of how long a frame
+// takes to draw; frames are paced at FRAME_RATE and draw the ball
+// interpolated between the last two ticks.
 void game_loop(GameState *state, WINDOW *win)
 {
+  struct timespec last, deadline;
+  clock_gettime(CLOCK_MONOTONIC, &last);
+  deadline = last;
+  double lag = 0;
+
   while (state->balls_remaining > 0)
   {
-    int pressed = wgetch(win);
-
-    if (pressed == 'w' || pressed == 'W')
+    if (!read_input(state, win))
     {
-      if (state->player_left.pos.y - state->player_left.height / 2 > 1)
-      {
-        state->player_left.pos.y -= 1.0f;
-      }
-    }
-    else if (pressed == 's' || pressed == 'S')
-    {
-      if (state->player_left.pos.y + state->player_left.height / 2 < SCREEN_HEIGHT - 1)
-      {
-        state->player_left.pos.y += 1.0f;
-      }
+      break;
     }
 
-    if (pressed == KEY_UP)
+    lag += elapsed_seconds(&last) * TICK_RATE;
+    if (lag > MAX_FRAME_TICKS)
     {
-      if (state->player_right.pos.y - state->player_right.height / 2 > 1)
-      {
-        state->player_right.pos.y -= 1.0f;
-      }
+      lag = MAX_FRAME_TICKS;
     }
-    else if (pressed == KEY_DOWN)
+    while (lag >= 1 && state->balls_remaining > 0)
     {
-      if (state->player_right.pos.y + state->player_right.height / 2 < SCREEN_HEIGHT - 1)
-      {
-        state->player_right.pos.y += 1.0f;
-      }
+      step_physics(state);
+      lag -= 1;
     }
 
-    if (pressed == 27)
-    {
-      break;
-    }
+    draw_game(state, lag);
+    wait_for_frame(&deadline);
+  }
+}
 
-    state->ball.pos.x += state->ball.vel.x;
-    state->ball.pos.y += state->ball.vel.y;
+// Drains every pending key so paddle moves are not limited to one per frame.
+bool read_input(GameState *state, WINDOW *win)
+{
+  int pressed;
+  while ((pressed = wgetch(win)) != ERR)
+  {
+    if (pressed == 'w' || pressed == 'W')
+      move_paddle(&state->player_left, -1);
+    else if (pressed == 's' || pressed == 'S')
+      move_paddle(&state->player_left, 1);
+    else if (pressed == KEY_UP)
+      move_paddle(&state->player_right, -1);
+    else if (pressed == KEY_DOWN)
+      move_paddle(&state->player_right, 1);
+    else if (pressed == 27)
+      return false;
+  }
+  return true;
+}
 
-    check_ball_collide(state);
+void move_paddle(Paddle *paddle, int dy)
+{
+  if (dy < 0 && paddle->pos.y - paddle->height / 2 > 1)
+  {
+    paddle->pos.y -= 1.0f;
+  }
+  else if (dy > 0 && paddle->pos.y + paddle->height / 2 < SCREEN_HEIGHT - 1)
+  {
+    paddle->pos.y += 1.0f;
+  }
+}
 
-    if (state->ball.pos.x <= 0)
+void step_physics(GameState *state)
+{
+  if (state->chaos)
+  {
+    move_balls(state, (float)STEP_RATE / TICK_RATE);
+    return;
+  }
+
+  state->ball.prev = state->ball.pos;
+  if (state->serve_ticks > 0)
+  {
+    state->serve_ticks--;
+    return;
+  }
+
+  sweep_ball(state, (float)STEP_RATE / TICK_RATE);
+
+  if (state->ball.pos.x <= 0)
+  {
+    state->score_right++;
+    state->balls_remaining--;
+    if (state->balls_remaining > 0)
     {
-      state->score_right++;
-      state->balls_remaining--;
-      if (state->balls_remaining > 0)
-      {
-        reset_ball(state);
-      }
+      reset_ball(state);
     }
-    else if (state->ball.pos.x >= SCREEN_WIDTH)
+  }
+  else if (state->ball.pos.x >= SCREEN_WIDTH)
+  {
+    state->score_left++;
+    state->balls_remaining--;
+    if (state->balls_remaining > 0)
     {
-      state->score_left++;
-      state->balls_remaining--;
-      if (state->balls_remaining > 0)
-      {
-        reset_ball(state);
-      }
+      reset_ball(state);
     }
+  }
+}
 
-    erase();
+void draw_game(GameState *state, float alpha)
+{
+  Ball *ball = &state->ball;
+  float x = ball->prev.x + (ball->pos.x - ball->prev.x) * alpha;
+  float y = ball->prev.y + (ball->pos.y - ball->prev.y) * alpha;
 
-    draw_box();
+  erase();
 
-    mvaddch((int)state->ball.pos.y, (int)state->ball.pos.x, 'O');
+  draw_box();
 
-    draw_players(state);
+  if (state->chaos)
+  {
+    BallSet *balls = &state->balls;
+    for (int i = 0; i < balls->count; i++)
+    {
+      x = balls->prev_x[i] + (balls->x[i] - balls->prev_x[i]) * alpha;
+      y = balls->prev_y[i] + (balls->y[i] - balls->prev_y[i]) * alpha;
+      mvaddch((int)y, (int)x, 'O');
+    }
+  }
+  else
+  {
+    mvaddch((int)y, (int)x, 'O');
+  }
 
-    mvprintw(0, SCREEN_WIDTH / 2 - 5, "%d | %d", state->score_left, state->score_right);
-    mvprintw(SCREEN_HEIGHT - 1, 2, "Balls: %d", state->balls_remaining);
+  draw_players(state);
 
-    refresh();
-    usleep(50000);
+  mvprintw(0, SCREEN_WIDTH / 2 - 5, "%d | %d", state->score_left, state->score_right);
+  mvprintw(SCREEN_HEIGHT - 1, 2, "Balls: %d", state->chaos ? state->balls.count : state->balls_remaining);
+
+  refresh();
+}
+
+// Sleeps to an absolute deadline so drawing time does not stretch the
+// frame; after a stall the schedule restarts from now.
+void wait_for_frame(struct timespec *deadline)
+{
+  deadline->tv_nsec += 1000000000L / FRAME_RATE;
+  while (deadline->tv_nsec >= 1000000000L)
+  {
+    deadline->tv_nsec -= 1000000000L;
+    deadline->tv_sec++;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if ((now.tv_sec - deadline->tv_sec) + (now.tv_nsec - deadline->tv_nsec) / 1e9 > 1.0 / FRAME_RATE)
+  {
+    *deadline = now;
+    return;
   }
+
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL) != 0)
+    ;
+}
+
+// Returns the seconds since *since and moves it to now.
+double elapsed_seconds(struct timespec *since)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double elapsed = (now.tv_sec - since->tv_sec) + (now.tv_nsec - since->tv_nsec) / 1e9;
+  *since = now;
+  return elapsed;
 }
 
 void dispatch_ball(GameState *state)
@@ -199,38 +376,97 @@ void reset_ball(GameState *state)
 {
   state->ball.pos.x = SCREEN_WIDTH / 2.0f;
   state->ball.pos.y = SCREEN_HEIGHT / 2.0f;
+  state->ball.prev = state->ball.pos;
+  state->serve_ticks = SERVE_TICKS;
   dispatch_ball(state);
-  usleep(500000);
 }
 
-void check_ball_collide(GameState *state)
+// Moves the ball dt steps along its velocity, stopping at the first wall or
+// paddle face the path crosses and reflecting from there, so a fast ball
+// bounces at its exact time of impact instead of tunnelling through.
+void sweep_ball(GameState *state, float dt)
 {
   Ball *ball = &state->ball;
+  float top = 0;
+  float bottom = SCREEN_HEIGHT - 1;
+  float left = state->player_left.pos.x + 1;
+  float right = state->player_right.pos.x - 1;
 
-  if (ball->pos.y <= 0 || ball->pos.y >= SCREEN_HEIGHT - 1)
-    ball->vel.y = -ball->vel.y;
-
-  if ((int)ball->pos.x == (int)state->player_left.pos.x + 1)
+  for (int bounce = 0; bounce <= MAX_BOUNCES && dt > 0; bounce++)
   {
-    float dy = ball->pos.y - state->player_left.pos.y;
-    if (fabs(dy) <= state->player_left.height / 2)
+    float hit = dt;
+    Surface surface = SURFACE_NONE;
+
+    if (ball->vel.y < 0)
+      earliest_hit(&hit, &surface, SURFACE_TOP, (top - ball->pos.y) / ball->vel.y);
+    else if (ball->vel.y > 0)
+      earliest_hit(&hit, &surface, SURFACE_BOTTOM, (bottom - ball->pos.y) / ball->vel.y);
+
+    if (ball->vel.x < 0 && ball->pos.x >= left)
     {
-      ball->vel.x = fabs(ball->vel.x);
-      ball->vel.y = dy * 0.3f;
+      float time = (left - ball->pos.x) / ball->vel.x;
+      if (paddle_covers(&state->player_left, ball->pos.y + ball->vel.y * time))
+        earliest_hit(&hit, &surface, SURFACE_LEFT, time);
+    }
+    else if (ball->vel.x > 0 && ball->pos.x <= right)
+    {
+      float time = (right - ball->pos.x) / ball->vel.x;
+      if (paddle_covers(&state->player_right, ball->pos.y + ball->vel.y * time))
+        earliest_hit(&hit, &surface, SURFACE_RIGHT, time);
     }
-  }
 
-  if ((int)ball->pos.x == (int)state->player_right.pos.x - 1)
-  {
-    float dy = ball->pos.y - state->player_right.pos.y;
-    if (fabs(dy) <= state->player_right.height / 2)
+    if (bounce == MAX_BOUNCES && surface != SURFACE_NONE)
+      break;
+
+    ball->pos.x += ball->vel.x * hit;
+    ball->pos.y += ball->vel.y * hit;
+    dt -= hit;
+
+    if (surface == SURFACE_TOP)
     {
+      ball->pos.y = top;
+      ball->vel.y = fabs(ball->vel.y);
+    }
+    else if (surface == SURFACE_BOTTOM)
+    {
+      ball->pos.y = bottom;
+      ball->vel.y = -fabs(ball->vel.y);
+    }
+    else if (surface == SURFACE_LEFT)
+    {
+      ball->pos.x = left;
+      ball->vel.x = fabs(ball->vel.x);
+      ball->vel.y = (ball->pos.y - state->player_left.pos.y) * 0.3f;
+    }
+    else if (surface == SURFACE_RIGHT)
+    {
+      ball->pos.x = right;
       ball->vel.x = -fabs(ball->vel.x);
-      ball->vel.y = dy * 0.3f;
+      ball->vel.y = (ball->pos.y - state->player_right.pos.y) * 0.3f;
+    }
+    else
+    {
+      break;
     }
   }
 }
 
+void earliest_hit(float *hit, Surface *surface, Surface candidate, float time)
+{
+  if (time < 0)
+    time = 0;
+  if (time <= *hit)
+  {
+    *hit = time;
+    *surface = candidate;
+  }
+}
+
+bool paddle_covers(Paddle *paddle, float y)
+{
+  return fabs(y - paddle->pos.y) <= paddle->height / 2;
+}
+
 void draw_box()
 {
   for (int i = 0; i < SCREEN_WIDTH; i++)
@@ -268,3 +504,214 @@ void draw_players(GameState *state)
     }
   }
 }
+
+bool init_balls(BallSet *balls, int count)
+{
+  memset(balls, 0, sizeof(*balls));
+  if (count < 1)
+    return false;
+
+  int padded = (count + 7) & ~7;
+  balls->count = count;
+  balls->x = malloc(padded * sizeof(float));
+  balls->y = malloc(padded * sizeof(float));
+  balls->prev_x = malloc(padded * sizeof(float));
+  balls->prev_y = malloc(padded * sizeof(float));
+  balls->vel_x = malloc(padded * sizeof(float));
+  balls->vel_y = malloc(padded * sizeof(float));
+  balls->serve = malloc(padded * sizeof(int32_t));
+
+  // Padding lanes sit still in the middle of the field and never score.
+  for (int i = 0; i < padded; i++)
+  {
+    balls->x[i] = balls->prev_x[i] = SCREEN_WIDTH / 2.0f;
+    balls->y[i] = balls->prev_y[i] = SCREEN_HEIGHT / 2.0f;
+    balls->vel_x[i] = 0;
+    balls->vel_y[i] = 0;
+    balls->serve[i] = 0;
+  }
+  return true;
+}
+
+void free_balls(BallSet *balls)
+{
+  free(balls->x);
+  free(balls->y);
+  free(balls->prev_x);
+  free(balls->prev_y);
+  free(balls->vel_x);
+  free(balls->vel_y);
+  free(balls->serve);
+  memset(balls, 0, sizeof(*balls));
+}
+
+// Chaos serves vary speed, angle and delay so the balls do not travel in a
+// handful of identical streams.
+void serve_ball(BallSet *balls, int i)
+{
+  int dir = rand() % 2 ? 1 : -1;
+  balls->x[i] = balls->prev_x[i] = SCREEN_WIDTH / 2.0f;
+  balls->y[i] = balls->prev_y[i] = SCREEN_HEIGHT / 2.0f;
+  balls->vel_x[i] = dir * (0.5f + (float)rand() / RAND_MAX);
+  balls->vel_y[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+  balls->serve[i] = rand() % SERVE_TICKS;
+}
+
+static inline bool any8(const mask8 *mask)
+{
+  uint64_t words[4];
+  memcpy(words, mask, sizeof(words));
+  return (words[0] | words[1] | words[2] | words[3]) != 0;
+}
+
+// Maps a straight path between the walls at 0 and SCREEN_HEIGHT - 1 back
+// into the field: folding by the wall period gives the bounced position and
+// flips the velocity once per odd number of bounces, all without branches.
+static inline void fold_walls(lanes8 *y, lanes8 *vel_y)
+{
+  const float height = SCREEN_HEIGHT - 1;
+  lanes8 period = (lanes8){0} + 2 * height;
+  lanes8 turns = __builtin_convertvector(__builtin_convertvector(*y / period, mask8), lanes8);
+  turns -= select8(turns > *y / period, (lanes8){0} + 1, (lanes8){0});
+  lanes8 m = *y - turns * period;
+  mask8 mirrored = m > height;
+  *y = select8(mirrored, period - m, m);
+  *vel_y = select8(mirrored, -*vel_y, *vel_y);
+}
+
+// Vector twin of sweep_ball: each pass moves every lane either to the paddle
+// face it hits first or through its whole remaining time, with walls folded
+// in; only lanes that hit a paddle need another pass.
+SIMD_CLONES void move_balls(GameState *state, float dt)
+{
+  BallSet *balls = &state->balls;
+  float left = state->player_left.pos.x + 1;
+  float right = state->player_right.pos.x - 1;
+  lanes8 zero = {0};
+
+  for (int i = 0; i < balls->count; i += 8)
+  {
+    lanes8 x;
+    lanes8 y;
+    lanes8 vel_x;
+    lanes8 vel_y;
+    mask8 serve;
+    memcpy(&x, balls->x + i, sizeof(x));
+    memcpy(&y, balls->y + i, sizeof(y));
+    memcpy(&vel_x, balls->vel_x + i, sizeof(vel_x));
+    memcpy(&vel_y, balls->vel_y + i, sizeof(vel_y));
+    memcpy(&serve, balls->serve + i, sizeof(serve));
+    memcpy(balls->prev_x + i, &x, sizeof(x));
+    memcpy(balls->prev_y + i, &y, sizeof(y));
+
+    lanes8 remaining = select8(serve > 0, zero, zero + dt);
+    serve -= (serve > 0) & 1;
+
+    mask8 moving = remaining > 0;
+    for (int bounce = 0; bounce <= MAX_BOUNCES && any8(&moving); bounce++)
+    {
+      mask8 toward_left = vel_x < 0;
+      lanes8 face = select8(toward_left, zero + left, zero + right);
+      lanes8 paddle_y = select8(toward_left, zero + state->player_left.pos.y, zero + state->player_right.pos.y);
+      lanes8 half = select8(toward_left, zero + (float)(state->player_left.height / 2), zero + (float)(state->player_right.height / 2));
+      mask8 front = select8(toward_left, x - face, face - x) >= 0;
+      lanes8 time = (face - x) / select8(vel_x != 0, vel_x, zero + 1);
+      mask8 crossing = front & (vel_x != 0) & (time <= remaining);
+
+      lanes8 hit_y = y + vel_y * time;
+      lanes8 hit_vel_y = vel_y;
+      fold_walls(&hit_y, &hit_vel_y);
+      lanes8 offset = hit_y - paddle_y;
+      mask8 hit = crossing & (select8(offset < 0, -offset, offset) <= half);
+      if (bounce == MAX_BOUNCES)
+        remaining = select8(hit, zero, remaining);
+
+      lanes8 step = select8(hit, time, remaining);
+      x = select8(hit, face, x + vel_x * step);
+      y += vel_y * step;
+      fold_walls(&y, &vel_y);
+      vel_x = select8(hit, -vel_x, vel_x);
+      vel_y = select8(hit, offset * 0.3f, vel_y);
+      remaining = select8(hit, remaining - time, zero);
+      moving = remaining > 0;
+    }
+
+    memcpy(balls->x + i, &x, sizeof(x));
+    memcpy(balls->y + i, &y, sizeof(y));
+    memcpy(balls->vel_x + i, &vel_x, sizeof(vel_x));
+    memcpy(balls->vel_y + i, &vel_y, sizeof(vel_y));
+    memcpy(balls->serve + i, &serve, sizeof(serve));
+
+    mask8 out = (x <= 0) | (x >= SCREEN_WIDTH);
+    if (!any8(&out))
+      continue;
+    for (int k = i; k < i + 8 && k < balls->count; k++)
+    {
+      if (balls->x[k] <= 0)
+      {
+        state->score_right++;
+        serve_ball(balls, k);
+      }
+      else if (balls->x[k] >= SCREEN_WIDTH)
+      {
+        state->score_left++;
+        serve_ball(balls, k);
+      }
+    }
+  }
+}
+
+int run_bench(int argc, char *argv[])
+{
+  static const int COUNTS[] = {1, 10, 100, 1000, 10000, 100000};
+  long ticks = BENCH_TICKS;
+  unsigned seed = BENCH_SEED;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+      ticks = atol(argv[++i]);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+      seed = (unsigned)strtoul(argv[++i], NULL, 10);
+  }
+
+  if (ticks < 1)
+  {
+    fprintf(stderr, "Usage: %s --bench [--ticks N] [--seed N]\n", argv[0]);
+    return 1;
+  }
+
+  for (size_t c = 0; c < sizeof(COUNTS) / sizeof(COUNTS[0]); c++)
+  {
+    GameState state = {0};
+    srand(seed);
+    init_balls(&state.balls, COUNTS[c]);
+    state.chaos = true;
+    init_game_state(&state);
+
+    // Paddles sweep the field so balls both bounce and score.
+    double seconds = 0;
+    for (long tick = 0; tick < ticks; tick++)
+    {
+      int span = SCREEN_HEIGHT - PADDLE_HEIGHT - 3;
+      int phase = (int)(tick / 6 % (2 * span));
+      state.player_left.pos.y = 1 + PADDLE_HEIGHT / 2 + (phase < span ? phase : 2 * span - phase);
+      state.player_right.pos.y = SCREEN_HEIGHT - 2 - PADDLE_HEIGHT / 2 - (phase < span ? phase : 2 * span - phase);
+
+      struct timespec start, end;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      step_physics(&state);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      seconds += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    }
+
+    double tick_us = seconds * 1e6 / ticks;
+    double frame_us = tick_us * TICK_RATE / FRAME_RATE;
+    printf("{\"bench\":\"chaos\",\"balls\":%d,\"ticks\":%ld,\"seconds\":%.3f,\"tick_us\":%.2f,\"ns_per_ball\":%.2f,"
+           "\"frame_us\":%.1f,\"frame_budget\":%.4f,\"points\":%d}\n",
+           COUNTS[c], ticks, seconds, tick_us, tick_us * 1e3 / COUNTS[c], frame_us, frame_us * FRAME_RATE / 1e6,
+           state.score_left + state.score_right);
+    free_balls(&state.balls);
+  }
+  return 0;
+}
@@ -1,14 +1,53 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <curses.h>
 #include <time.h>
 
-#define MAX_SEGMENTS 256
+#define INITIAL_CAPACITY 256
 #define SCREEN_WIDTH 80
 #define SCREEN_HEIGHT 30
 #define INITIAL_INTERVAL 150000
 #define SPEED_INCREMENT 5000
 #define MIN_INTERVAL 30000
+#define TURN_QUEUE 3
+#define BENCH_GAMES 100
+#define BENCH_SEED 12345
+#define BENCH_STALL_FACTOR 4
+#define MAX_BACKOFF 32
+#define CYCLE_MARGIN 2
+#define BATCH_MAX_THREADS 64
+#define BATCH_ENVS 4096
+#define BATCH_STEPS 2000
+#define BATCH_BOARD 16
+#define ARENA_SIZE 4096
+#define ARENA_SNAKES 10000
+#define ARENA_TICKS 600
+#define ARENA_TILE 64
+#define ARENA_TILE_BERRIES 4
+#define ARENA_SPAWN_ATTEMPTS 64
+
+#define ACTION_STRAIGHT 0
+#define ACTION_LEFT 1
+#define ACTION_RIGHT 2
+
+#define OBS_DANGER_STRAIGHT (1 << 0)
+#define OBS_DANGER_LEFT (1 << 1)
+#define OBS_DANGER_RIGHT (1 << 2)
+#define OBS_DIRECTION 3
+#define OBS_BERRY_LEFT (1 << 7)
+#define OBS_BERRY_RIGHT (1 << 8)
+#define OBS_BERRY_UP (1 << 9)
+#define OBS_BERRY_DOWN (1 << 10)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_CLONES __attribute__((target_clones("avx2", "sse4.1", "default")))
+#else
+#define SIMD_CLONES
+#endif
 
 typedef struct
 {
@@ -18,25 +57,234 @@ typedef struct
 
 typedef struct
 {
-  vec2 segments[MAX_SEGMENTS];
+  int width;
+  int height;
+  uint64_t *occupied;
+  int *free_cells;
+  int *free_index;
+  int free_count;
+  vec2 *segments;
+  int capacity;
+  int tail;
+  int length;
   int score;
   vec2 head;
   vec2 dir;
   vec2 berry;
   int interval;
   char head_char;
+  bool autopilot;
+  vec2 turns[TURN_QUEUE];
+  int turn_count;
+  struct timespec deadline;
+  long ticks;
+  double jitter_total;
+  double jitter_max;
 } GameState;
 
-void game_loop(GameState *state, WINDOW *win);
+typedef struct
+{
+  int width;
+  int height;
+  int *cycle;
+  int *cost;
+  int *stamp;
+  int *parent;
+  int *queue;
+  uint64_t *heap;
+  uint64_t *scratch;
+  int search;
+  int *path;
+  int path_length;
+  int path_index;
+  vec2 path_target;
+  int *order;
+  int cycle_length;
+  int failures;
+  int backoff;
+} Autopilot;
+
+// N independent games stored column-wise. Cells are indices into a
+// width x height board whose border is wall; each game owns a slice of the
+// body ring, occupancy bitmap and free-cell set. Finished games restart in
+// place, so observations always describe a live game.
+typedef int32_t lanes32 __attribute__((vector_size(32)));
+
+typedef struct SnakeBatch
+{
+  int count;
+  int width;
+  int height;
+  int cells;
+  int words;
+  int ring;
+  int32_t *head_x;
+  int32_t *head_y;
+  int32_t *dir;
+  int32_t *berry_x;
+  int32_t *berry_y;
+  int32_t *tail;
+  int32_t *length;
+  int32_t *score;
+  int32_t *idle;
+  int32_t *next;
+  int32_t *free_count;
+  uint64_t *rng;
+  uint16_t *bodies;
+  uint16_t *free_cells;
+  uint16_t *free_index;
+  uint64_t *occupied;
+  uint16_t *column;
+  uint16_t *row;
+  uint16_t *observations;
+  float *rewards;
+  uint8_t *dones;
+  const uint8_t *actions;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  pthread_t threads[BATCH_MAX_THREADS];
+  int thread_count;
+  int job;
+  int active;
+  bool stop;
+} SnakeBatch;
+
+typedef struct
+{
+  SnakeBatch *batch;
+  int id;
+} BatchWorker;
+
+typedef struct
+{
+  uint32_t *cells;
+  int capacity;
+  int tail;
+  int length;
+  int score;
+  uint32_t head;
+  int dir;
+  int32_t target;
+} ArenaSnake;
+
+typedef struct
+{
+  int begin;
+  int end;
+  uint32_t *moves;
+  uint32_t *pops;
+  int *move_offsets;
+  int *pop_offsets;
+  long steps;
+  long eaten;
+} ArenaWorker;
+
+// Thousands of snakes on one square grid. The grid is cut into bands of
+// ARENA_TILE rows; during a tick each band is owned by one thread, which
+// clears the tails and resolves the head claims that land in it. Claims are
+// replayed in snake id order, so the lowest id wins a contested cell however
+// the bands are spread over threads. Berries live in fixed slots per tile and
+// respawn inside their tile from a per-tile generator.
+typedef struct
+{
+  int size;
+  int tiles;
+  int count;
+  uint64_t *occupied;
+  uint64_t *berries;
+  int32_t *slots;
+  uint64_t *tile_rng;
+  ArenaSnake *snakes;
+  uint32_t *next;
+  uint32_t *tail_cell;
+  uint8_t *flags;
+  ArenaWorker workers[BATCH_MAX_THREADS];
+  int thread_count;
+  pthread_barrier_t barrier;
+  long tick_limit;
+  long ticks;
+  long deaths;
+  uint64_t rng;
+} Arena;
+
+typedef struct
+{
+  Arena *arena;
+  int id;
+} ArenaThread;
+
+static const vec2 DIRECTIONS[4] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+
+void game_loop(GameState *state, Autopilot *ai, WINDOW *win);
+bool advance_game(GameState *state);
+void set_direction(GameState *state, vec2 dir);
+bool read_input(GameState *state, WINDOW *win);
+void queue_turn(GameState *state, vec2 dir);
+void wait_for_tick(GameState *state);
 void fetch_segments(GameState *state);
 void draw_box(void);
 bool is_game_over(const GameState *state);
-void spawn_berry(GameState *state);
+bool spawn_berry(GameState *state);
 bool is_position_occupied(const GameState *state, vec2 pos);
-void init_game_state(GameState *state);
+void init_game_state(GameState *state, int width, int height);
+void free_game_state(GameState *state);
+void grow_segments(GameState *state);
+void occupy_cell(GameState *state, vec2 pos);
+void vacate_cell(GameState *state, vec2 pos);
+void autopilot_prepare(Autopilot *ai, int width, int height);
+void autopilot_free(Autopilot *ai);
+void autopilot_reset(Autopilot *ai);
+bool shortcut_allowed(const Autopilot *ai, const GameState *state, int cell);
+bool shortcuts_enabled(const Autopilot *ai, const GameState *state);
+vec2 autopilot_direction(Autopilot *ai, const GameState *state);
+bool find_path(Autopilot *ai, const GameState *state, int from, int to);
+bool path_is_safe(Autopilot *ai, const GameState *state);
+int reachable(Autopilot *ai, const GameState *state, const uint64_t *occupied, int from, int to);
+vec2 fallback_direction(Autopilot *ai, const GameState *state);
+int run_bench(int argc, char *argv[]);
+bool batch_init(SnakeBatch *batch, int count, int width, int height, uint64_t seed);
+void batch_free(SnakeBatch *batch);
+void batch_step(SnakeBatch *batch, const uint8_t *actions);
+void batch_reset(SnakeBatch *batch, int i);
+void batch_spawn(SnakeBatch *batch, int i);
+void batch_range(SnakeBatch *batch, int begin, int end);
+void batch_observe(SnakeBatch *batch, int begin, int end);
+void *batch_worker(void *arg);
+int batch_slice(const SnakeBatch *batch, int id);
+int run_batch_bench(int argc, char *argv[]);
+uint64_t next_random(uint64_t *rng);
+bool arena_init(Arena *arena, int size, int count, int threads, uint64_t seed);
+void arena_free(Arena *arena);
+void arena_spawn_snake(Arena *arena, int i);
+void arena_spawn_berry(Arena *arena, int tile, int slot);
+void arena_decide(Arena *arena, ArenaWorker *worker);
+void arena_resolve(Arena *arena, int band);
+void arena_apply(Arena *arena, ArenaWorker *worker);
+void arena_bury(Arena *arena);
+void *arena_thread(void *arg);
+int run_arena_bench(int argc, char *argv[]);
+
+static inline vec2 segment_at(const GameState *state, int i)
+{
+  return state->segments[(state->tail + i) & (state->capacity - 1)];
+}
 
-int main(void)
+int main(int argc, char *argv[])
 {
+  bool autopilot = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--bench") == 0)
+      return run_bench(argc, argv);
+    if (strcmp(argv[i], "--batch-bench") == 0)
+      return run_batch_bench(argc, argv);
+    if (strcmp(argv[i], "--arena") == 0)
+      return run_arena_bench(argc, argv);
+    if (strcmp(argv[i], "--autopilot") == 0)
+      autopilot = true;
+  }
+
   srand(time(NULL));
   WINDOW *win = initscr();
   keypad(win, true);
@@ -44,12 +292,15 @@ int main(void)
   curs_set(0);
   noecho();
 
-  GameState state;
+  GameState state = {0};
+  Autopilot ai = {0};
+  state.autopilot = autopilot;
 
   while (true)
   {
-    init_game_state(&state);
-    game_loop(&state, win);
+    init_game_state(&state, SCREEN_WIDTH / 2, SCREEN_HEIGHT + 1);
+    autopilot_reset(&ai);
+    game_loop(&state, &ai, win);
 
     nodelay(win, false);
     erase();
@@ -64,6 +315,8 @@ int main(void)
       pressed = wgetch(win);
       if (pressed == 27)
       {
+        free_game_state(&state);
+        autopilot_free(&ai);
         endwin();
         return 0;
       }
@@ -77,136 +330,300 @@ int main(void)
   }
 }
 
-void init_game_state(GameState *state)
+void init_game_state(GameState *state, int width, int height)
 {
+  int cells = width * height;
+  if (state->occupied == NULL || state->width * state->height != cells)
+  {
+    free(state->occupied);
+    free(state->free_cells);
+    free(state->free_index);
+    state->occupied = malloc((cells + 63) / 64 * sizeof(uint64_t));
+    state->free_cells = malloc(cells * sizeof(int));
+    state->free_index = malloc(cells * sizeof(int));
+  }
+
   state->score = 0;
-  for (int i = 0; i < MAX_SEGMENTS; i++)
+  state->width = width;
+  state->height = height;
+  memset(state->occupied, 0, (cells + 63) / 64 * sizeof(uint64_t));
+  state->free_count = 0;
+  for (int cell = 0; cell < cells; cell++)
+  {
+    int x = cell % state->width;
+    int y = cell / state->width;
+    if (x == 0 || y == 0 || x == state->width - 1 || y == state->height - 1)
+    {
+      state->occupied[cell / 64] |= 1ULL << (cell % 64);
+      state->free_index[cell] = -1;
+    }
+    else
+    {
+      state->free_index[cell] = state->free_count;
+      state->free_cells[state->free_count++] = cell;
+    }
+  }
+
+  if (state->segments == NULL)
   {
-    state->segments[i] = (vec2){0, 0};
+    state->capacity = INITIAL_CAPACITY;
+    state->segments = malloc(state->capacity * sizeof(vec2));
   }
-  state->head = (vec2){SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2};
+  state->tail = 0;
+  state->length = 0;
+  state->head = (vec2){width / 2, (height - 1) / 2};
+  occupy_cell(state, state->head);
   state->dir = (vec2){1, 0};
   state->interval = INITIAL_INTERVAL;
   state->head_char = '>';
   spawn_berry(state);
 }
 
-void spawn_berry(GameState *state)
+bool spawn_berry(GameState *state)
 {
-  vec2 new_berry;
-  int attempts = 0;
-  const int max_attempts = 100;
-
-  do
-  {
-    new_berry.x = (rand() % (SCREEN_WIDTH / 2 - 2)) + 1;
-    new_berry.y = (rand() % (SCREEN_HEIGHT - 2)) + 1;
-    attempts++;
-  } while (is_position_occupied(state, new_berry) && attempts < max_attempts);
+  if (state->free_count == 0)
+    return false;
 
-  state->berry = new_berry;
+  int cell = state->free_cells[rand() % state->free_count];
+  state->berry = (vec2){cell % state->width, cell / state->width};
+  return true;
 }
 
 bool is_position_occupied(const GameState *state, vec2 pos)
 {
-  if (pos.x == state->head.x && pos.y == state->head.y)
-  {
-    return true;
-  }
+  int cell = pos.y * state->width + pos.x;
+  return (state->occupied[cell / 64] >> (cell % 64)) & 1;
+}
 
-  for (int i = 0; i < state->score; i++)
-  {
-    if (pos.x == state->segments[i].x && pos.y == state->segments[i].y)
-    {
-      return true;
-    }
-  }
+void occupy_cell(GameState *state, vec2 pos)
+{
+  int cell = pos.y * state->width + pos.x;
+  state->occupied[cell / 64] |= 1ULL << (cell % 64);
 
-  return false;
+  int index = state->free_index[cell];
+  int last = state->free_cells[--state->free_count];
+  state->free_cells[index] = last;
+  state->free_index[last] = index;
+  state->free_index[cell] = -1;
+}
+
+void vacate_cell(GameState *state, vec2 pos)
+{
+  int cell = pos.y * state->width + pos.x;
+  state->occupied[cell / 64] &= ~(1ULL << (cell % 64));
+  state->free_index[cell] = state->free_count;
+  state->free_cells[state->free_count++] = cell;
+}
+
+void free_game_state(GameState *state)
+{
+  free(state->segments);
+  free(state->occupied);
+  free(state->free_cells);
+  free(state->free_index);
+  state->segments = NULL;
+  state->occupied = NULL;
+  state->capacity = 0;
 }
 
-void game_loop(GameState *state, WINDOW *win)
+void game_loop(GameState *state, Autopilot *ai, WINDOW *win)
 {
+  clock_gettime(CLOCK_MONOTONIC, &state->deadline);
+  state->turn_count = 0;
+  state->ticks = 0;
+  state->jitter_total = 0;
+  state->jitter_max = 0;
+
   while (true)
   {
-    int pressed = wgetch(win);
-
-    if (pressed == KEY_LEFT && state->dir.x != 1)
-    {
-      state->dir = (vec2){-1, 0};
-      state->head_char = '<';
-    }
-    else if (pressed == KEY_RIGHT && state->dir.x != -1)
+    if (!read_input(state, win))
     {
-      state->dir = (vec2){1, 0};
-      state->head_char = '>';
+      break;
     }
-    else if (pressed == KEY_UP && state->dir.y != 1)
+
+    if (state->autopilot)
     {
-      state->dir = (vec2){0, -1};
-      state->head_char = '^';
+      state->turn_count = 0;
+      set_direction(state, autopilot_direction(ai, state));
     }
-    else if (pressed == KEY_DOWN && state->dir.y != -1)
+    else if (state->turn_count > 0)
     {
-      state->dir = (vec2){0, 1};
-      state->head_char = 'v';
-    }
-    else if (pressed == 27)
-    { // ESC
-      break;
+      set_direction(state, state->turns[0]);
+      state->turn_count--;
+      memmove(state->turns, state->turns + 1, state->turn_count * sizeof(vec2));
     }
 
-    fetch_segments(state);
-
-    state->head.x += state->dir.x;
-    state->head.y += state->dir.y;
-
-    if (is_game_over(state))
+    if (!advance_game(state))
     {
       break;
     }
 
-    if (state->head.x == state->berry.x && state->head.y == state->berry.y)
-    {
-      state->score++;
-
-      if (state->interval > MIN_INTERVAL)
-      {
-        state->interval -= SPEED_INCREMENT;
-        if (state->interval < MIN_INTERVAL)
-        {
-          state->interval = MIN_INTERVAL;
-        }
-      }
-
-      spawn_berry(state);
-    }
-
     erase();
     draw_box();
     mvaddch(state->berry.y, state->berry.x * 2, '@' | A_BOLD | COLOR_PAIR(1));
 
-    for (int i = 0; i < state->score; i++)
+    for (int i = 0; i < state->length; i++)
     {
-      mvaddch(state->segments[i].y, state->segments[i].x * 2, 'o');
+      vec2 segment = segment_at(state, i);
+      mvaddch(segment.y, segment.x * 2, 'o');
     }
 
     mvaddch(state->head.y, state->head.x * 2, state->head_char | A_BOLD);
     mvprintw(0, SCREEN_WIDTH + 2, "Score: %d", state->score);
     mvprintw(1, SCREEN_WIDTH + 2, "Speed: %d", (INITIAL_INTERVAL - state->interval) / SPEED_INCREMENT);
+    if (state->autopilot)
+    {
+      mvprintw(2, SCREEN_WIDTH + 2, "Autopilot (A)");
+    }
+    if (state->ticks > 0)
+    {
+      mvprintw(3, SCREEN_WIDTH + 2, "Jitter: %.0f us (max %.0f)", state->jitter_total / state->ticks, state->jitter_max);
+    }
 
     refresh();
-    usleep(state->interval);
+    wait_for_tick(state);
+  }
+}
+
+// Drains every pending key; turns are queued and applied one per tick.
+bool read_input(GameState *state, WINDOW *win)
+{
+  int pressed;
+  while ((pressed = wgetch(win)) != ERR)
+  {
+    if (pressed == KEY_LEFT)
+      queue_turn(state, (vec2){-1, 0});
+    else if (pressed == KEY_RIGHT)
+      queue_turn(state, (vec2){1, 0});
+    else if (pressed == KEY_UP)
+      queue_turn(state, (vec2){0, -1});
+    else if (pressed == KEY_DOWN)
+      queue_turn(state, (vec2){0, 1});
+    else if (pressed == 'a' || pressed == 'A')
+      state->autopilot = !state->autopilot;
+    else if (pressed == 27) // ESC
+      return false;
+  }
+  return true;
+}
+
+// A turn is checked against the last queued direction, so a quick
+// up-then-left from moving right is kept as two turns.
+void queue_turn(GameState *state, vec2 dir)
+{
+  vec2 last = state->turn_count > 0 ? state->turns[state->turn_count - 1] : state->dir;
+  if (state->turn_count == TURN_QUEUE || (dir.x == last.x && dir.y == last.y) || (dir.x == -last.x && dir.y == -last.y))
+    return;
+  state->turns[state->turn_count++] = dir;
+}
+
+// Sleeps to an absolute deadline so input, logic and drawing time do not
+// stretch the tick; if a tick overruns by a whole interval, the schedule
+// restarts from now instead of bursting to catch up.
+void wait_for_tick(GameState *state)
+{
+  state->deadline.tv_nsec += state->interval * 1000L;
+  while (state->deadline.tv_nsec >= 1000000000L)
+  {
+    state->deadline.tv_nsec -= 1000000000L;
+    state->deadline.tv_sec++;
+  }
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double behind = (now.tv_sec - state->deadline.tv_sec) * 1e6 + (now.tv_nsec - state->deadline.tv_nsec) / 1e3;
+  if (behind > state->interval)
+  {
+    state->deadline = now;
+    return;
+  }
+
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &state->deadline, NULL) != 0)
+    ;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double late = (now.tv_sec - state->deadline.tv_sec) * 1e6 + (now.tv_nsec - state->deadline.tv_nsec) / 1e3;
+  state->ticks++;
+  state->jitter_total += late;
+  if (late > state->jitter_max)
+    state->jitter_max = late;
+}
+
+bool advance_game(GameState *state)
+{
+  fetch_segments(state);
+
+  state->head.x += state->dir.x;
+  state->head.y += state->dir.y;
+
+  if (is_game_over(state))
+  {
+    return false;
+  }
+  occupy_cell(state, state->head);
+
+  if (state->head.x == state->berry.x && state->head.y == state->berry.y)
+  {
+    state->score++;
+
+    if (state->interval > MIN_INTERVAL)
+    {
+      state->interval -= SPEED_INCREMENT;
+      if (state->interval < MIN_INTERVAL)
+      {
+        state->interval = MIN_INTERVAL;
+      }
+    }
+
+    return spawn_berry(state);
   }
+
+  return true;
+}
+
+void set_direction(GameState *state, vec2 dir)
+{
+  state->dir = dir;
+  if (dir.x == 1)
+    state->head_char = '>';
+  else if (dir.x == -1)
+    state->head_char = '<';
+  else if (dir.y == -1)
+    state->head_char = '^';
+  else
+    state->head_char = 'v';
 }
 
 void fetch_segments(GameState *state)
 {
-  for (int i = state->score; i > 0; i--)
+  if (state->length == state->capacity)
+    grow_segments(state);
+
+  state->segments[(state->tail + state->length) & (state->capacity - 1)] = state->head;
+  state->length++;
+
+  if (state->length > state->score)
   {
-    state->segments[i] = state->segments[i - 1];
+    vacate_cell(state, state->segments[state->tail]);
+    state->tail = (state->tail + 1) & (state->capacity - 1);
+    state->length--;
   }
-  state->segments[0] = state->head;
+}
+
+void grow_segments(GameState *state)
+{
+  vec2 *segments = malloc(state->capacity * 2 * sizeof(vec2));
+  int first = state->capacity - state->tail;
+  if (first > state->length)
+    first = state->length;
+
+  memcpy(segments, state->segments + state->tail, first * sizeof(vec2));
+  memcpy(segments + first, state->segments, (state->length - first) * sizeof(vec2));
+
+  free(state->segments);
+  state->segments = segments;
+  state->capacity *= 2;
+  state->tail = 0;
 }
 
 void draw_box(void)
@@ -226,18 +643,1385 @@ void draw_box(void)
 
 bool is_game_over(const GameState *state)
 {
-  if (state->head.x <= 0 || state->head.x >= (SCREEN_WIDTH / 2) - 1 || state->head.y <= 0 || state->head.y >= SCREEN_HEIGHT)
+  return is_position_occupied(state, state->head);
+}
+
+void autopilot_prepare(Autopilot *ai, int width, int height)
+{
+  if (ai->cycle != NULL && ai->width == width && ai->height == height)
+    return;
+
+  autopilot_free(ai);
+  int cells = width * height;
+  ai->width = width;
+  ai->height = height;
+  ai->cycle = malloc(cells * sizeof(int));
+  ai->order = malloc(cells * sizeof(int));
+  ai->cost = malloc(cells * sizeof(int));
+  ai->stamp = calloc(cells, sizeof(int));
+  ai->parent = malloc(cells * sizeof(int));
+  ai->queue = malloc(cells * sizeof(int));
+  ai->heap = malloc((4 * cells + 1) * sizeof(uint64_t));
+  ai->scratch = malloc((cells + 63) / 64 * sizeof(uint64_t));
+  ai->path = malloc(cells * sizeof(int));
+
+  // Serpentine over the interior columns, returning along the top row; needs
+  // an even number of columns, otherwise the same walk runs over the rows.
+  for (int cell = 0; cell < cells; cell++)
+    ai->cycle[cell] = -1;
+
+  int cols = width - 2;
+  int rows = height - 2;
+  bool by_columns = cols % 2 == 0;
+  int lanes = by_columns ? cols : rows;
+  int span = by_columns ? rows : cols;
+  if (lanes % 2 != 0 || span < 2)
+    return;
+
+  int first = -1;
+  int previous = -1;
+  for (int lane = 0; lane < lanes + 1; lane++)
+  {
+    int steps = lane == lanes ? lanes : span - 1;
+    for (int i = 0; i < steps; i++)
+    {
+      int along = lane == lanes ? 0 : lane % 2 == 0 ? i + 1 : span - 1 - i;
+      int across = lane == lanes ? lanes - 1 - i : lane;
+
+      int x = 1 + (by_columns ? across : along);
+      int y = 1 + (by_columns ? along : across);
+      int cell = y * width + x;
+      if (previous >= 0)
+        ai->cycle[previous] = cell;
+      else
+        first = cell;
+      ai->order[cell] = ai->cycle_length++;
+      previous = cell;
+    }
+  }
+  ai->cycle[previous] = first;
+}
+
+void autopilot_free(Autopilot *ai)
+{
+  free(ai->cycle);
+  free(ai->order);
+  free(ai->cost);
+  free(ai->stamp);
+  free(ai->parent);
+  free(ai->queue);
+  free(ai->heap);
+  free(ai->scratch);
+  free(ai->path);
+  memset(ai, 0, sizeof(*ai));
+}
+
+void autopilot_reset(Autopilot *ai)
+{
+  ai->path_length = 0;
+  ai->path_index = 0;
+  ai->failures = 0;
+  ai->backoff = 0;
+}
+
+vec2 autopilot_direction(Autopilot *ai, const GameState *state)
+{
+  autopilot_prepare(ai, state->width, state->height);
+
+  int head = state->head.y * state->width + state->head.x;
+  int berry = state->berry.y * state->width + state->berry.x;
+  bool on_cycle = ai->cycle[head] >= 0;
+  bool cached = ai->path_index < ai->path_length && ai->path_target.x == state->berry.x && ai->path_target.y == state->berry.y;
+
+  // A rejected plan only changes as the tail frees cells, so retries back off.
+  bool planned = false;
+  if (!cached && ai->backoff > 0)
+  {
+    ai->backoff--;
+  }
+  else if (on_cycle && !shortcuts_enabled(ai, state))
+  {
+    cached = false;
+  }
+  else if (!cached && (planned = true) && find_path(ai, state, head, berry) && (on_cycle || path_is_safe(ai, state)))
+  {
+    ai->path_index = 0;
+    ai->path_target = state->berry;
+    cached = true;
+  }
+
+  if (cached)
+  {
+    int next = ai->path[ai->path_index];
+    vec2 pos = {next % state->width, next / state->width};
+    if (!is_position_occupied(state, pos) && abs(pos.x - state->head.x) + abs(pos.y - state->head.y) == 1 &&
+        (!on_cycle || shortcut_allowed(ai, state, next)))
+    {
+      ai->path_index++;
+      ai->failures = 0;
+      return (vec2){pos.x - state->head.x, pos.y - state->head.y};
+    }
+  }
+
+  if (planned || cached)
   {
+    ai->failures++;
+    ai->backoff = ai->failures < MAX_BACKOFF ? ai->failures : MAX_BACKOFF;
+  }
+  ai->path_length = 0;
+  ai->path_index = 0;
+  return fallback_direction(ai, state);
+}
+
+bool shortcuts_enabled(const Autopilot *ai, const GameState *state)
+{
+  return 2 * (state->score + 1) <= ai->cycle_length;
+}
+
+// The body always lies in cycle order between tail and head, so any cell that
+// keeps the head ahead of the tail on the cycle (with room to grow) is safe.
+// Shortcuts never overshoot the berry, which rules out loops, and stop once
+// the snake fills half the cycle so the body closes up before it gets tight.
+bool shortcut_allowed(const Autopilot *ai, const GameState *state, int cell)
+{
+  int head = state->head.y * state->width + state->head.x;
+  int berry = state->berry.y * state->width + state->berry.x;
+  int ahead = (ai->order[cell] - ai->order[head] + ai->cycle_length) % ai->cycle_length;
+  if (ahead == 1)
     return true;
+  if (!shortcuts_enabled(ai, state) || ahead > (ai->order[berry] - ai->order[head] + ai->cycle_length) % ai->cycle_length)
+    return false;
+
+  int gap = ai->cycle_length;
+  if (state->length > 0)
+  {
+    vec2 segment = segment_at(state, 0);
+    int tail = segment.y * state->width + segment.x;
+    gap = (ai->order[tail] - ai->order[head] + ai->cycle_length) % ai->cycle_length;
   }
 
-  for (int i = 0; i < state->score; i++)
+  int growth = state->score - state->length + (cell == berry);
+  return ahead < gap - growth - CYCLE_MARGIN;
+}
+
+// A* over free cells. On a board with a cycle the search only moves forward
+// in cycle order up to the berry, so every step of the result is a legal
+// shortcut and the search never leaves that arc.
+bool find_path(Autopilot *ai, const GameState *state, int from, int to)
+{
+  int width = state->width;
+  int goal_x = to % width;
+  int goal_y = to / width;
+  int search = ++ai->search;
+  int count = 0;
+
+  bool on_cycle = ai->cycle[from] >= 0;
+  int base = on_cycle ? ai->order[from] : 0;
+  int limit = on_cycle ? (ai->order[to] - base + ai->cycle_length) % ai->cycle_length : 0;
+  if (on_cycle && !shortcut_allowed(ai, state, to))
+    return false;
+
+  ai->stamp[from] = search;
+  ai->cost[from] = 0;
+  ai->heap[count++] = (uint64_t)(abs(from % width - goal_x) + abs(from / width - goal_y)) << 32 | from;
+
+  while (count > 0)
   {
-    if (state->head.x == state->segments[i].x && state->head.y == state->segments[i].y)
+    uint64_t top = ai->heap[0];
+    uint64_t last = ai->heap[--count];
+    int i = 0;
+    while (2 * i + 1 < count)
+    {
+      int child = 2 * i + 1;
+      if (child + 1 < count && ai->heap[child + 1] < ai->heap[child])
+        child++;
+      if (ai->heap[child] >= last)
+        break;
+      ai->heap[i] = ai->heap[child];
+      i = child;
+    }
+    ai->heap[i] = last;
+
+    int cell = (int)(top & 0xFFFFFFFF);
+    int x = cell % width;
+    int y = cell / width;
+    if ((int)(top >> 32) > ai->cost[cell] + abs(x - goal_x) + abs(y - goal_y))
+      continue;
+
+    if (cell == to)
     {
+      int length = ai->cost[to];
+      for (int step = to, k = length - 1; step != from; step = ai->parent[step], k--)
+        ai->path[k] = step;
+      ai->path_length = length;
       return true;
     }
+
+    for (int d = 0; d < 4; d++)
+    {
+      vec2 next = {x + DIRECTIONS[d].x, y + DIRECTIONS[d].y};
+      int neighbor = next.y * width + next.x;
+      int cost = ai->cost[cell] + 1;
+      if (is_position_occupied(state, next) || (ai->stamp[neighbor] == search && ai->cost[neighbor] <= cost))
+        continue;
+      if (on_cycle)
+      {
+        int ahead = (ai->order[neighbor] - base + ai->cycle_length) % ai->cycle_length;
+        if (ahead <= (ai->order[cell] - base + ai->cycle_length) % ai->cycle_length || ahead > limit)
+          continue;
+      }
+
+      ai->stamp[neighbor] = search;
+      ai->cost[neighbor] = cost;
+      ai->parent[neighbor] = cell;
+
+      uint64_t key = (uint64_t)(cost + abs(next.x - goal_x) + abs(next.y - goal_y)) << 32 | neighbor;
+      int j = count++;
+      while (j > 0 && ai->heap[(j - 1) / 2] > key)
+      {
+        ai->heap[j] = ai->heap[(j - 1) / 2];
+        j = (j - 1) / 2;
+      }
+      ai->heap[j] = key;
+    }
   }
 
   return false;
 }
+
+// Replays the cached path on a scratch copy of the board and checks that the
+// head can still reach the tail once the berry has been eaten.
+bool path_is_safe(Autopilot *ai, const GameState *state)
+{
+  int width = state->width;
+  int words = (width * state->height + 63) / 64;
+  memcpy(ai->scratch, state->occupied, words * sizeof(uint64_t));
+
+  int total = state->length + 1 + ai->path_length;
+  int keep = state->score + 2 < total ? state->score + 2 : total;
+  int drop = total - keep;
+
+  int tail = -1;
+  for (int i = 0; i <= drop && i < total; i++)
+  {
+    int cell;
+    if (i < state->length)
+    {
+      vec2 segment = segment_at(state, i);
+      cell = segment.y * width + segment.x;
+    }
+    else if (i == state->length)
+      cell = state->head.y * width + state->head.x;
+    else
+      cell = ai->path[i - state->length - 1];
+
+    if (i == drop)
+      tail = cell;
+    else
+      ai->scratch[cell / 64] &= ~(1ULL << (cell % 64));
+  }
+
+  for (int i = 0; i < ai->path_length; i++)
+  {
+    int cell = ai->path[i];
+    if (state->length + 1 + i >= drop)
+      ai->scratch[cell / 64] |= 1ULL << (cell % 64);
+  }
+
+  return reachable(ai, state, ai->scratch, ai->path[ai->path_length - 1], tail) >= 0;
+}
+
+// Breadth-first distance from `from` to `to` over free cells of `occupied`;
+// `to` itself may be occupied (it is the tail about to move). -1 if unreachable.
+// With `to` = -1 the whole region is flooded and left in cost/stamp.
+int reachable(Autopilot *ai, const GameState *state, const uint64_t *occupied, int from, int to)
+{
+  int width = state->width;
+  int search = ++ai->search;
+  int head = 0;
+  int count = 0;
+
+  ai->stamp[from] = search;
+  ai->cost[from] = 0;
+  ai->queue[count++] = from;
+
+  while (head < count)
+  {
+    int cell = ai->queue[head++];
+    for (int d = 0; d < 4; d++)
+    {
+      int neighbor = cell + DIRECTIONS[d].y * width + DIRECTIONS[d].x;
+      if (neighbor == to)
+        return ai->cost[cell] + 1;
+      if (ai->stamp[neighbor] == search || ((occupied[neighbor / 64] >> (neighbor % 64)) & 1))
+        continue;
+      ai->stamp[neighbor] = search;
+      ai->cost[neighbor] = ai->cost[cell] + 1;
+      ai->queue[count++] = neighbor;
+    }
+  }
+
+  return -1;
+}
+
+vec2 fallback_direction(Autopilot *ai, const GameState *state)
+{
+  int width = state->width;
+  int head = state->head.y * width + state->head.x;
+  int tail = head;
+  if (state->length > 0)
+  {
+    vec2 segment = segment_at(state, 0);
+    tail = segment.y * width + segment.x;
+  }
+  bool tail_moves = state->length > 0 && state->length == state->score;
+
+  // On the cycle, skip as far toward the berry as the tail allows.
+  if (ai->cycle[head] >= 0)
+  {
+    int best = -1;
+    int best_ahead = 0;
+    for (int d = 0; d < 4; d++)
+    {
+      vec2 next = {state->head.x + DIRECTIONS[d].x, state->head.y + DIRECTIONS[d].y};
+      int cell = next.y * width + next.x;
+      if (ai->cycle[cell] < 0 || (is_position_occupied(state, next) && !(tail_moves && cell == tail)))
+        continue;
+      int ahead = (ai->order[cell] - ai->order[head] + ai->cycle_length) % ai->cycle_length;
+      if (ahead > best_ahead && shortcut_allowed(ai, state, cell))
+      {
+        best = d;
+        best_ahead = ahead;
+      }
+    }
+
+    int next = best >= 0 ? head + DIRECTIONS[best].y * width + DIRECTIONS[best].x : ai->cycle[head];
+    return (vec2){next % width - state->head.x, next / width - state->head.y};
+  }
+
+  // Stay on the cycle while it keeps the tail in reach, otherwise take the
+  // longest route back to the tail.
+  if (state->length > 0)
+    reachable(ai, state, state->occupied, tail, -1);
+
+  int best = -1;
+  int best_distance = -1;
+  int any = -1;
+  for (int d = 0; d < 4; d++)
+  {
+    vec2 next = {state->head.x + DIRECTIONS[d].x, state->head.y + DIRECTIONS[d].y};
+    int cell = next.y * width + next.x;
+    if (is_position_occupied(state, next) && !(tail_moves && cell == tail))
+      continue;
+    if (any < 0 || cell == ai->cycle[head])
+      any = d;
+    if (state->length == 0)
+      continue;
+
+    int distance = cell == tail ? 0 : ai->stamp[cell] == ai->search ? ai->cost[cell] : -1;
+    if (distance >= 0 && cell == ai->cycle[head])
+    {
+      best = d;
+      break;
+    }
+    if (distance > best_distance)
+    {
+      best = d;
+      best_distance = distance;
+    }
+  }
+
+  if (best >= 0)
+    return DIRECTIONS[best];
+  if (any >= 0)
+    return DIRECTIONS[any];
+  return state->dir;
+}
+
+int run_bench(int argc, char *argv[])
+{
+  int width = SCREEN_WIDTH / 2;
+  int height = SCREEN_HEIGHT + 1;
+  long games = BENCH_GAMES;
+  unsigned seed = BENCH_SEED;
+  int sizes = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--games") == 0 && i + 1 < argc)
+      games = atol(argv[++i]);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+      seed = (unsigned)strtoul(argv[++i], NULL, 10);
+    else if (argv[i][0] != '-' && sizes == 0)
+    {
+      width = atoi(argv[i]) + 2;
+      sizes++;
+    }
+    else if (argv[i][0] != '-' && sizes == 1)
+    {
+      height = atoi(argv[i]) + 2;
+      sizes++;
+    }
+  }
+
+  if (width < 4 || height < 4 || games < 1)
+  {
+    fprintf(stderr, "Usage: %s --bench [WIDTH HEIGHT] [--games N] [--seed N]\n", argv[0]);
+    return 1;
+  }
+
+  srand(seed);
+  GameState state = {0};
+  Autopilot ai = {0};
+  long steps = 0;
+  long total_length = 0;
+  int best_length = 0;
+  int filled = 0;
+  int stalled = 0;
+  int cells = (width - 2) * (height - 2);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long game = 0; game < games; game++)
+  {
+    init_game_state(&state, width, height);
+    autopilot_reset(&ai);
+    long idle = 0;
+    int score = 0;
+    while (true)
+    {
+      set_direction(&state, autopilot_direction(&ai, &state));
+      steps++;
+      if (!advance_game(&state))
+        break;
+      if (state.score != score)
+      {
+        score = state.score;
+        idle = 0;
+      }
+      else if (++idle > (long)cells * BENCH_STALL_FACTOR)
+      {
+        stalled++;
+        break;
+      }
+    }
+
+    int length = state.length + 1;
+    total_length += length;
+    if (length > best_length)
+      best_length = length;
+    if (state.free_count == 0)
+      filled++;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  printf("{\"bench\":\"autopilot\",\"width\":%d,\"height\":%d,\"games\":%ld,\"steps\":%ld,\"seconds\":%.3f,"
+         "\"steps_per_second\":%.0f,\"mean_length\":%.1f,\"max_length\":%d,\"filled\":%d,\"stalled\":%d}\n",
+         width - 2, height - 2, games, steps, seconds, seconds > 0 ? steps / seconds : 0.0,
+         (double)total_length / games, best_length, filled, stalled);
+
+  free_game_state(&state);
+  autopilot_free(&ai);
+  return 0;
+}
+
+uint64_t next_random(uint64_t *rng)
+{
+  uint64_t z = (*rng += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+bool batch_init(SnakeBatch *batch, int count, int width, int height, uint64_t seed)
+{
+  memset(batch, 0, sizeof(*batch));
+  if (count < 1 || width < 4 || height < 4 || width * height > 65535)
+    return false;
+
+  batch->count = count;
+  batch->width = width;
+  batch->height = height;
+  batch->cells = width * height;
+  batch->words = (batch->cells + 63) / 64;
+  batch->ring = 1;
+  while (batch->ring < batch->cells)
+    batch->ring *= 2;
+
+  // Padded to whole vectors so the SIMD loops never need a scalar tail.
+  int padded = (count + 7) / 8 * 8;
+  batch->head_x = calloc(padded, sizeof(int32_t));
+  batch->head_y = calloc(padded, sizeof(int32_t));
+  batch->dir = calloc(padded, sizeof(int32_t));
+  batch->berry_x = calloc(padded, sizeof(int32_t));
+  batch->berry_y = calloc(padded, sizeof(int32_t));
+  batch->tail = malloc(count * sizeof(int32_t));
+  batch->length = malloc(count * sizeof(int32_t));
+  batch->score = malloc(count * sizeof(int32_t));
+  batch->idle = malloc(count * sizeof(int32_t));
+  batch->next = calloc(padded, sizeof(int32_t));
+  batch->free_count = malloc(count * sizeof(int32_t));
+  batch->rng = malloc(count * sizeof(uint64_t));
+  batch->bodies = malloc((size_t)count * batch->ring * sizeof(uint16_t));
+  batch->free_cells = malloc((size_t)count * batch->cells * sizeof(uint16_t));
+  batch->free_index = malloc((size_t)count * batch->cells * sizeof(uint16_t));
+  batch->occupied = malloc((size_t)count * batch->words * sizeof(uint64_t));
+  batch->column = malloc(batch->cells * sizeof(uint16_t));
+  batch->row = malloc(batch->cells * sizeof(uint16_t));
+  batch->observations = calloc(padded, sizeof(uint16_t));
+  batch->rewards = calloc(count, sizeof(float));
+  batch->dones = calloc(count, sizeof(uint8_t));
+
+  for (int cell = 0; cell < batch->cells; cell++)
+  {
+    batch->column[cell] = cell % width;
+    batch->row[cell] = cell / width;
+  }
+  for (int i = 0; i < count; i++)
+  {
+    batch->rng[i] = seed + 0x9E3779B97F4A7C15ULL * i;
+    batch_reset(batch, i);
+  }
+  batch_observe(batch, 0, count);
+
+  long threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads < 1)
+    threads = 1;
+  if (threads > BATCH_MAX_THREADS)
+    threads = BATCH_MAX_THREADS;
+  if (threads > count)
+    threads = count;
+
+  pthread_mutex_init(&batch->lock, NULL);
+  pthread_cond_init(&batch->wake, NULL);
+  pthread_cond_init(&batch->done, NULL);
+  batch->thread_count = threads;
+  for (long i = 1; i < threads; i++)
+  {
+    BatchWorker *worker = malloc(sizeof(BatchWorker));
+    *worker = (BatchWorker){batch, i};
+    pthread_create(&batch->threads[i], NULL, batch_worker, worker);
+  }
+  return true;
+}
+
+void batch_free(SnakeBatch *batch)
+{
+  pthread_mutex_lock(&batch->lock);
+  batch->stop = true;
+  pthread_cond_broadcast(&batch->wake);
+  pthread_mutex_unlock(&batch->lock);
+  for (int i = 1; i < batch->thread_count; i++)
+    pthread_join(batch->threads[i], NULL);
+  pthread_mutex_destroy(&batch->lock);
+  pthread_cond_destroy(&batch->wake);
+  pthread_cond_destroy(&batch->done);
+
+  free(batch->head_x);
+  free(batch->head_y);
+  free(batch->dir);
+  free(batch->berry_x);
+  free(batch->berry_y);
+  free(batch->tail);
+  free(batch->length);
+  free(batch->score);
+  free(batch->idle);
+  free(batch->next);
+  free(batch->free_count);
+  free(batch->rng);
+  free(batch->bodies);
+  free(batch->free_cells);
+  free(batch->free_index);
+  free(batch->occupied);
+  free(batch->column);
+  free(batch->row);
+  free(batch->observations);
+  free(batch->rewards);
+  free(batch->dones);
+  memset(batch, 0, sizeof(*batch));
+}
+
+// Applies one action per game (ACTION_STRAIGHT/LEFT/RIGHT) and fills
+// observations, rewards (+1 berry, -1 death) and dones.
+void batch_step(SnakeBatch *batch, const uint8_t *actions)
+{
+  if (batch->thread_count == 1)
+  {
+    batch->actions = actions;
+    batch_range(batch, 0, batch->count);
+    return;
+  }
+
+  pthread_mutex_lock(&batch->lock);
+  batch->actions = actions;
+  batch->active = batch->thread_count;
+  batch->job++;
+  pthread_cond_broadcast(&batch->wake);
+  pthread_mutex_unlock(&batch->lock);
+
+  batch_range(batch, 0, batch_slice(batch, 1));
+
+  pthread_mutex_lock(&batch->lock);
+  if (--batch->active > 0)
+  {
+    while (batch->active > 0)
+      pthread_cond_wait(&batch->done, &batch->lock);
+  }
+  pthread_mutex_unlock(&batch->lock);
+}
+
+int batch_slice(const SnakeBatch *batch, int id)
+{
+  if (id >= batch->thread_count)
+    return batch->count;
+  return (int)((long)(batch->count + 7) / 8 * id / batch->thread_count * 8);
+}
+
+void *batch_worker(void *arg)
+{
+  BatchWorker worker = *(BatchWorker *)arg;
+  free(arg);
+  SnakeBatch *batch = worker.batch;
+  int seen = 0;
+
+  pthread_mutex_lock(&batch->lock);
+  while (true)
+  {
+    while (batch->job == seen && !batch->stop)
+      pthread_cond_wait(&batch->wake, &batch->lock);
+    if (batch->stop)
+      break;
+    seen = batch->job;
+    pthread_mutex_unlock(&batch->lock);
+
+    batch_range(batch, batch_slice(batch, worker.id), batch_slice(batch, worker.id + 1));
+
+    pthread_mutex_lock(&batch->lock);
+    if (--batch->active == 0)
+      pthread_cond_signal(&batch->done);
+  }
+  pthread_mutex_unlock(&batch->lock);
+  return NULL;
+}
+
+void batch_reset(SnakeBatch *batch, int i)
+{
+  int width = batch->width;
+  uint64_t *occupied = batch->occupied + (size_t)i * batch->words;
+  uint16_t *free_cells = batch->free_cells + (size_t)i * batch->cells;
+  uint16_t *free_index = batch->free_index + (size_t)i * batch->cells;
+
+  memset(occupied, 0, batch->words * sizeof(uint64_t));
+  int count = 0;
+  for (int cell = 0; cell < batch->cells; cell++)
+  {
+    int x = batch->column[cell];
+    int y = batch->row[cell];
+    if (x == 0 || y == 0 || x == width - 1 || y == batch->height - 1)
+    {
+      occupied[cell / 64] |= 1ULL << (cell % 64);
+      free_index[cell] = UINT16_MAX;
+    }
+    else
+    {
+      free_index[cell] = count;
+      free_cells[count++] = cell;
+    }
+  }
+
+  int head = (batch->height / 2) * width + width / 2;
+  int index = free_index[head];
+  int last = free_cells[--count];
+  free_cells[index] = last;
+  free_index[last] = index;
+  free_index[head] = UINT16_MAX;
+  occupied[head / 64] |= 1ULL << (head % 64);
+
+  batch->free_count[i] = count;
+  batch->head_x[i] = width / 2;
+  batch->head_y[i] = batch->height / 2;
+  batch->dir[i] = 0;
+  batch->tail[i] = 0;
+  batch->length[i] = 1;
+  batch->score[i] = 0;
+  batch->idle[i] = 0;
+  batch->bodies[(size_t)i * batch->ring] = head;
+  batch_spawn(batch, i);
+}
+
+void batch_spawn(SnakeBatch *batch, int i)
+{
+  int count = batch->free_count[i];
+  if (count == 0)
+  {
+    batch->berry_x[i] = -1;
+    batch->berry_y[i] = -1;
+    return;
+  }
+  uint64_t pick = (next_random(&batch->rng[i]) >> 32) * count >> 32;
+  int cell = batch->free_cells[(size_t)i * batch->cells + pick];
+  batch->berry_x[i] = batch->column[cell];
+  batch->berry_y[i] = batch->row[cell];
+}
+
+// Runs games [begin, end); begin is a multiple of 8 and the arrays are padded,
+// so the vector loops cover whole lanes.
+SIMD_CLONES void batch_range(SnakeBatch *batch, int begin, int end)
+{
+  int width = batch->width;
+  int32_t *head_x = batch->head_x;
+  int32_t *head_y = batch->head_y;
+  int32_t *dir = batch->dir;
+  int32_t *next = batch->next;
+
+  // Turn and move every game at once; walls are occupied, so no bounds tests.
+  // Vector comparisons yield -1 for true, so (a == b) & 1 is the 0/1 flag.
+  for (int i = begin; i < end; i += 8)
+  {
+    lanes32 action;
+    lanes32 d;
+    lanes32 x;
+    lanes32 y;
+    for (int k = 0; k < 8; k++)
+      action[k] = i + k < end ? batch->actions[i + k] : ACTION_STRAIGHT;
+    memcpy(&d, dir + i, sizeof(d));
+    memcpy(&x, head_x + i, sizeof(x));
+    memcpy(&y, head_y + i, sizeof(y));
+
+    d = (d + ((action == ACTION_LEFT) & 3) + ((action == ACTION_RIGHT) & 1)) & 3;
+    x += ((d == 0) & 1) - ((d == 2) & 1);
+    y += ((d == 1) & 1) - ((d == 3) & 1);
+    lanes32 cell = y * width + x;
+
+    memcpy(dir + i, &d, sizeof(d));
+    memcpy(head_x + i, &x, sizeof(x));
+    memcpy(head_y + i, &y, sizeof(y));
+    memcpy(next + i, &cell, sizeof(cell));
+  }
+
+  for (int i = begin; i < end; i++)
+  {
+    uint64_t *occupied = batch->occupied + (size_t)i * batch->words;
+    uint16_t *free_cells = batch->free_cells + (size_t)i * batch->cells;
+    uint16_t *free_index = batch->free_index + (size_t)i * batch->cells;
+    uint16_t *body = batch->bodies + (size_t)i * batch->ring;
+    int mask = batch->ring - 1;
+    int cell = next[i];
+
+    if (batch->length[i] == batch->score[i] + 1)
+    {
+      int tail = body[batch->tail[i]];
+      occupied[tail / 64] &= ~(1ULL << (tail % 64));
+      free_index[tail] = batch->free_count[i];
+      free_cells[batch->free_count[i]++] = tail;
+      batch->tail[i] = (batch->tail[i] + 1) & mask;
+      batch->length[i]--;
+    }
+
+    if ((occupied[cell / 64] >> (cell % 64)) & 1 || ++batch->idle[i] > batch->cells * BENCH_STALL_FACTOR)
+    {
+      batch->rewards[i] = (occupied[cell / 64] >> (cell % 64)) & 1 ? -1.0f : 0.0f;
+      batch->dones[i] = 1;
+      batch_reset(batch, i);
+      continue;
+    }
+
+    occupied[cell / 64] |= 1ULL << (cell % 64);
+    int index = free_index[cell];
+    int last = free_cells[--batch->free_count[i]];
+    free_cells[index] = last;
+    free_index[last] = index;
+    free_index[cell] = UINT16_MAX;
+    body[(batch->tail[i] + batch->length[i]++) & mask] = cell;
+    batch->rewards[i] = 0.0f;
+    batch->dones[i] = 0;
+
+    if (head_x[i] == batch->berry_x[i] && head_y[i] == batch->berry_y[i])
+    {
+      batch->score[i]++;
+      batch->idle[i] = 0;
+      batch->rewards[i] = 1.0f;
+      batch_spawn(batch, i);
+      if (batch->berry_x[i] < 0)
+      {
+        batch->dones[i] = 1;
+        batch_reset(batch, i);
+      }
+    }
+  }
+
+  batch_observe(batch, begin, end);
+}
+
+SIMD_CLONES void batch_observe(SnakeBatch *batch, int begin, int end)
+{
+  int width = batch->width;
+  const int32_t *head_x = batch->head_x;
+  const int32_t *head_y = batch->head_y;
+  const int32_t *dir = batch->dir;
+  uint16_t *observations = batch->observations;
+
+  for (int i = begin; i < end; i += 8)
+  {
+    lanes32 x;
+    lanes32 y;
+    lanes32 bx;
+    lanes32 by;
+    lanes32 d;
+    memcpy(&x, head_x + i, sizeof(x));
+    memcpy(&y, head_y + i, sizeof(y));
+    memcpy(&bx, batch->berry_x + i, sizeof(bx));
+    memcpy(&by, batch->berry_y + i, sizeof(by));
+    memcpy(&d, dir + i, sizeof(d));
+
+    lanes32 one = {1, 1, 1, 1, 1, 1, 1, 1};
+    lanes32 obs = (one << (d + OBS_DIRECTION)) | ((bx < x) & OBS_BERRY_LEFT) |
+                  ((bx > x) & OBS_BERRY_RIGHT) | ((by < y) & OBS_BERRY_UP) | ((by > y) & OBS_BERRY_DOWN);
+    for (int k = 0; k < 8; k++)
+      observations[i + k] = obs[k];
+  }
+
+  for (int i = begin; i < end; i++)
+  {
+    const uint64_t *occupied = batch->occupied + (size_t)i * batch->words;
+    int h = head_y[i] * width + head_x[i];
+    int d = dir[i];
+    int ahead = h + DIRECTIONS[d].x + DIRECTIONS[d].y * width;
+    int left = h + DIRECTIONS[(d + 3) & 3].x + DIRECTIONS[(d + 3) & 3].y * width;
+    int right = 2 * h - left;
+    observations[i] |= ((occupied[ahead / 64] >> (ahead % 64)) & 1) * OBS_DANGER_STRAIGHT |
+                       ((occupied[left / 64] >> (left % 64)) & 1) * OBS_DANGER_LEFT |
+                       ((occupied[right / 64] >> (right % 64)) & 1) * OBS_DANGER_RIGHT;
+  }
+}
+
+int run_batch_bench(int argc, char *argv[])
+{
+  int envs = BATCH_ENVS;
+  long steps = BATCH_STEPS;
+  int width = BATCH_BOARD + 2;
+  int height = BATCH_BOARD + 2;
+  uint64_t seed = BENCH_SEED;
+  int sizes = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--envs") == 0 && i + 1 < argc)
+      envs = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+      steps = atol(argv[++i]);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+      seed = strtoull(argv[++i], NULL, 10);
+    else if (argv[i][0] != '-' && sizes == 0)
+    {
+      width = atoi(argv[i]) + 2;
+      sizes++;
+    }
+    else if (argv[i][0] != '-' && sizes == 1)
+    {
+      height = atoi(argv[i]) + 2;
+      sizes++;
+    }
+  }
+
+  SnakeBatch batch;
+  if (steps < 1 || !batch_init(&batch, envs, width, height, seed))
+  {
+    fprintf(stderr, "Usage: %s --batch-bench [WIDTH HEIGHT] [--envs N] [--steps N] [--seed N]\n", argv[0]);
+    return 1;
+  }
+
+  // Greedy policy: turn toward the berry unless that runs into something.
+  uint8_t *actions = malloc(envs);
+  int32_t *scores = calloc(envs, sizeof(int32_t));
+  long episodes = 0;
+  long berries = 0;
+  double seconds = 0;
+  for (long step = 0; step < steps; step++)
+  {
+    for (int i = 0; i < envs; i++)
+    {
+      int obs = batch.observations[i];
+      int d = batch.dir[i];
+      int want = obs & OBS_BERRY_RIGHT ? 0 : obs & OBS_BERRY_DOWN ? 1 : obs & OBS_BERRY_LEFT ? 2 : 3;
+      int turn = (want - d) & 3;
+      int action = turn == 1 ? ACTION_RIGHT : turn == 0 ? ACTION_STRAIGHT : ACTION_LEFT;
+      int danger[3] = {obs & OBS_DANGER_STRAIGHT, obs & OBS_DANGER_LEFT, obs & OBS_DANGER_RIGHT};
+      for (int k = 0; k < 3 && danger[action]; k++)
+        action = (action + 1) % 3;
+      actions[i] = action;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    batch_step(&batch, actions);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    for (int i = 0; i < envs; i++)
+    {
+      scores[i] += batch.rewards[i] > 0;
+      if (batch.dones[i])
+      {
+        episodes++;
+        berries += scores[i];
+        scores[i] = 0;
+      }
+    }
+  }
+
+  long total = (long)envs * steps;
+  printf("{\"bench\":\"batch\",\"envs\":%d,\"width\":%d,\"height\":%d,\"threads\":%d,\"steps\":%ld,\"seconds\":%.3f,"
+         "\"steps_per_second\":%.0f,\"episodes\":%ld,\"mean_score\":%.2f}\n",
+         envs, width - 2, height - 2, batch.thread_count, total, seconds, seconds > 0 ? total / seconds : 0.0, episodes,
+         episodes > 0 ? (double)berries / episodes : 0.0);
+
+  free(actions);
+  free(scores);
+  batch_free(&batch);
+  return 0;
+}
+
+#define ARENA_POP 1
+#define ARENA_ATE 2
+#define ARENA_DEAD 4
+
+static inline bool arena_test(const uint64_t *bits, uint32_t cell)
+{
+  return (bits[cell / 64] >> (cell % 64)) & 1;
+}
+
+static inline int arena_tile(const Arena *arena, uint32_t cell)
+{
+  return (int)(cell / arena->size / ARENA_TILE) * arena->tiles + (int)(cell % arena->size) / ARENA_TILE;
+}
+
+bool arena_init(Arena *arena, int size, int count, int threads, uint64_t seed)
+{
+  memset(arena, 0, sizeof(*arena));
+  if (size < ARENA_TILE || size % ARENA_TILE != 0 || count < 1 || (long)count * 4 > (long)size * size)
+    return false;
+
+  size_t cells = (size_t)size * size;
+  arena->size = size;
+  arena->tiles = size / ARENA_TILE;
+  arena->count = count;
+  arena->rng = seed;
+  arena->occupied = calloc(cells / 64, sizeof(uint64_t));
+  arena->berries = calloc(cells / 64, sizeof(uint64_t));
+  arena->slots = malloc((size_t)arena->tiles * arena->tiles * ARENA_TILE_BERRIES * sizeof(int32_t));
+  arena->tile_rng = malloc((size_t)arena->tiles * arena->tiles * sizeof(uint64_t));
+  arena->snakes = calloc(count, sizeof(ArenaSnake));
+  arena->next = malloc(count * sizeof(uint32_t));
+  arena->tail_cell = malloc(count * sizeof(uint32_t));
+  arena->flags = calloc(count, sizeof(uint8_t));
+
+  for (int tile = 0; tile < arena->tiles * arena->tiles; tile++)
+  {
+    arena->tile_rng[tile] = seed ^ (0xD1B54A32D192ED03ULL * (tile + 1));
+    for (int slot = 0; slot < ARENA_TILE_BERRIES; slot++)
+      arena_spawn_berry(arena, tile, slot);
+  }
+  for (int i = 0; i < count; i++)
+    arena_spawn_snake(arena, i);
+
+  if (threads < 1)
+    threads = 1;
+  if (threads > BATCH_MAX_THREADS)
+    threads = BATCH_MAX_THREADS;
+  if (threads > count)
+    threads = count;
+  arena->thread_count = threads;
+  pthread_barrier_init(&arena->barrier, NULL, threads);
+
+  for (int t = 0; t < threads; t++)
+  {
+    ArenaWorker *worker = &arena->workers[t];
+    worker->begin = (int)((long)count * t / threads);
+    worker->end = (int)((long)count * (t + 1) / threads);
+    worker->moves = malloc((worker->end - worker->begin) * sizeof(uint32_t));
+    worker->pops = malloc((worker->end - worker->begin) * sizeof(uint32_t));
+    worker->move_offsets = malloc((arena->tiles + 1) * sizeof(int));
+    worker->pop_offsets = malloc((arena->tiles + 1) * sizeof(int));
+  }
+  return true;
+}
+
+void arena_free(Arena *arena)
+{
+  for (int i = 0; i < arena->count; i++)
+    free(arena->snakes[i].cells);
+  for (int t = 0; t < arena->thread_count; t++)
+  {
+    free(arena->workers[t].moves);
+    free(arena->workers[t].pops);
+    free(arena->workers[t].move_offsets);
+    free(arena->workers[t].pop_offsets);
+  }
+  if (arena->thread_count > 0)
+    pthread_barrier_destroy(&arena->barrier);
+  free(arena->occupied);
+  free(arena->berries);
+  free(arena->slots);
+  free(arena->tile_rng);
+  free(arena->snakes);
+  free(arena->next);
+  free(arena->tail_cell);
+  free(arena->flags);
+  memset(arena, 0, sizeof(*arena));
+}
+
+void arena_spawn_snake(Arena *arena, int i)
+{
+  ArenaSnake *snake = &arena->snakes[i];
+  int size = arena->size;
+  uint32_t cell = 0;
+  for (int attempt = 0; attempt < ARENA_SPAWN_ATTEMPTS; attempt++)
+  {
+    cell = (next_random(&arena->rng) >> 32) * ((uint64_t)size * size) >> 32;
+    if (!arena_test(arena->occupied, cell) && !arena_test(arena->berries, cell))
+      break;
+  }
+  if (arena_test(arena->occupied, cell))
+  {
+    snake->length = 0;
+    return;
+  }
+
+  if (snake->cells == NULL)
+  {
+    snake->capacity = 16;
+    snake->cells = malloc(snake->capacity * sizeof(uint32_t));
+  }
+  snake->cells[0] = cell;
+  snake->tail = 0;
+  snake->length = 1;
+  snake->score = 0;
+  snake->head = cell;
+  snake->dir = next_random(&arena->rng) & 3;
+  snake->target = -1;
+  arena->occupied[cell / 64] |= 1ULL << (cell % 64);
+}
+
+void arena_spawn_berry(Arena *arena, int tile, int slot)
+{
+  int32_t *berry = &arena->slots[tile * ARENA_TILE_BERRIES + slot];
+  int left = tile % arena->tiles * ARENA_TILE;
+  int top = tile / arena->tiles * ARENA_TILE;
+  *berry = -1;
+  for (int attempt = 0; attempt < ARENA_SPAWN_ATTEMPTS; attempt++)
+  {
+    uint64_t r = next_random(&arena->tile_rng[tile]);
+    uint32_t cell = (uint32_t)(top + (r & (ARENA_TILE - 1))) * arena->size + left + ((r >> 8) & (ARENA_TILE - 1));
+    if (!arena_test(arena->occupied, cell) && !arena_test(arena->berries, cell))
+    {
+      arena->berries[cell / 64] |= 1ULL << (cell % 64);
+      *berry = cell;
+      return;
+    }
+  }
+}
+
+// Read-only pass over the grid: every snake steers toward the nearest berry
+// in its 3x3 tile neighbourhood, never into an occupied cell if it can help
+// it, and its move and tail pop are bucketed by band.
+void arena_decide(Arena *arena, ArenaWorker *worker)
+{
+  int size = arena->size;
+  int bands = arena->tiles;
+  memset(worker->move_offsets, 0, (bands + 1) * sizeof(int));
+  memset(worker->pop_offsets, 0, (bands + 1) * sizeof(int));
+
+  for (int i = worker->begin; i < worker->end; i++)
+  {
+    ArenaSnake *snake = &arena->snakes[i];
+    arena->flags[i] = 0;
+    if (snake->length == 0)
+      continue;
+
+    int x = snake->head % size;
+    int y = snake->head / size;
+    if (snake->target < 0 || !arena_test(arena->berries, snake->target))
+    {
+      snake->target = -1;
+      int best = INT32_MAX;
+      int tx = x / ARENA_TILE;
+      int ty = y / ARENA_TILE;
+      for (int dy = -1; dy <= 1; dy++)
+      {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+          if (tx + dx < 0 || ty + dy < 0 || tx + dx >= arena->tiles || ty + dy >= arena->tiles)
+            continue;
+          const int32_t *slots = &arena->slots[((ty + dy) * arena->tiles + tx + dx) * ARENA_TILE_BERRIES];
+          for (int k = 0; k < ARENA_TILE_BERRIES; k++)
+          {
+            int distance = abs(slots[k] % size - x) + abs(slots[k] / size - y);
+            if (slots[k] >= 0 && distance < best)
+            {
+              best = distance;
+              snake->target = slots[k];
+            }
+          }
+        }
+      }
+    }
+
+    int best_dir = snake->dir;
+    int best_score = INT32_MAX;
+    for (int turn = 0; turn < 3; turn++)
+    {
+      int d = (snake->dir + (turn == 0 ? 0 : turn == 1 ? 3 : 1)) & 3;
+      int nx = x + DIRECTIONS[d].x;
+      int ny = y + DIRECTIONS[d].y;
+      if (nx < 0 || ny < 0 || nx >= size || ny >= size || arena_test(arena->occupied, (uint32_t)ny * size + nx))
+        continue;
+      int score = snake->target < 0 ? turn : abs(snake->target % size - nx) + abs(snake->target / size - ny);
+      if (score < best_score)
+      {
+        best_score = score;
+        best_dir = d;
+      }
+    }
+
+    int nx = x + DIRECTIONS[best_dir].x;
+    int ny = y + DIRECTIONS[best_dir].y;
+    snake->dir = best_dir;
+    if (nx < 0 || ny < 0 || nx >= size || ny >= size)
+    {
+      arena->flags[i] = ARENA_DEAD;
+      arena->next[i] = UINT32_MAX;
+    }
+    else
+    {
+      arena->next[i] = (uint32_t)ny * size + nx;
+      worker->move_offsets[ny / ARENA_TILE + 1]++;
+    }
+
+    if (snake->length == snake->score + 1)
+    {
+      arena->flags[i] |= ARENA_POP;
+      arena->tail_cell[i] = snake->cells[snake->tail];
+      worker->pop_offsets[arena->tail_cell[i] / size / ARENA_TILE + 1]++;
+    }
+  }
+
+  for (int band = 0; band < bands; band++)
+  {
+    worker->move_offsets[band + 1] += worker->move_offsets[band];
+    worker->pop_offsets[band + 1] += worker->pop_offsets[band];
+  }
+
+  int move_fill[bands];
+  int pop_fill[bands];
+  memcpy(move_fill, worker->move_offsets, bands * sizeof(int));
+  memcpy(pop_fill, worker->pop_offsets, bands * sizeof(int));
+  for (int i = worker->begin; i < worker->end; i++)
+  {
+    if (arena->snakes[i].length == 0)
+      continue;
+    if (arena->next[i] != UINT32_MAX)
+      worker->moves[move_fill[arena->next[i] / size / ARENA_TILE]++] = i;
+    if (arena->flags[i] & ARENA_POP)
+      worker->pops[pop_fill[arena->tail_cell[i] / size / ARENA_TILE]++] = i;
+  }
+}
+
+// Everything a band touches lies inside its rows: tails leaving it, heads
+// entering it and berries respawning in its tiles.
+void arena_resolve(Arena *arena, int band)
+{
+  for (int t = 0; t < arena->thread_count; t++)
+  {
+    ArenaWorker *worker = &arena->workers[t];
+    for (int k = worker->pop_offsets[band]; k < worker->pop_offsets[band + 1]; k++)
+    {
+      uint32_t cell = arena->tail_cell[worker->pops[k]];
+      arena->occupied[cell / 64] &= ~(1ULL << (cell % 64));
+    }
+  }
+
+  for (int t = 0; t < arena->thread_count; t++)
+  {
+    ArenaWorker *worker = &arena->workers[t];
+    for (int k = worker->move_offsets[band]; k < worker->move_offsets[band + 1]; k++)
+    {
+      int i = worker->moves[k];
+      uint32_t cell = arena->next[i];
+      if (arena_test(arena->occupied, cell))
+      {
+        arena->flags[i] |= ARENA_DEAD;
+        continue;
+      }
+      arena->occupied[cell / 64] |= 1ULL << (cell % 64);
+
+      if (arena_test(arena->berries, cell))
+      {
+        arena->berries[cell / 64] &= ~(1ULL << (cell % 64));
+        arena->flags[i] |= ARENA_ATE;
+        int tile = arena_tile(arena, cell);
+        for (int slot = 0; slot < ARENA_TILE_BERRIES; slot++)
+        {
+          if (arena->slots[tile * ARENA_TILE_BERRIES + slot] == (int32_t)cell)
+          {
+            arena_spawn_berry(arena, tile, slot);
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
+void arena_apply(Arena *arena, ArenaWorker *worker)
+{
+  for (int i = worker->begin; i < worker->end; i++)
+  {
+    ArenaSnake *snake = &arena->snakes[i];
+    if (snake->length == 0)
+      continue;
+
+    if (arena->flags[i] & ARENA_POP)
+    {
+      snake->tail = (snake->tail + 1) & (snake->capacity - 1);
+      snake->length--;
+    }
+    if (arena->flags[i] & ARENA_DEAD)
+      continue;
+
+    if (snake->length == snake->capacity)
+    {
+      uint32_t *cells = malloc(snake->capacity * 2 * sizeof(uint32_t));
+      for (int k = 0; k < snake->length; k++)
+        cells[k] = snake->cells[(snake->tail + k) & (snake->capacity - 1)];
+      free(snake->cells);
+      snake->cells = cells;
+      snake->capacity *= 2;
+      snake->tail = 0;
+    }
+    snake->cells[(snake->tail + snake->length++) & (snake->capacity - 1)] = arena->next[i];
+    snake->head = arena->next[i];
+    worker->steps++;
+    if (arena->flags[i] & ARENA_ATE)
+    {
+      snake->score++;
+      worker->eaten++;
+    }
+  }
+}
+
+// Serial step: dead bodies can span every band, so they are cleared and the
+// snakes respawned in id order on one thread.
+void arena_bury(Arena *arena)
+{
+  for (int i = 0; i < arena->count; i++)
+  {
+    ArenaSnake *snake = &arena->snakes[i];
+    if (!(arena->flags[i] & ARENA_DEAD) && snake->length > 0)
+      continue;
+
+    for (int k = 0; k < snake->length; k++)
+    {
+      uint32_t cell = snake->cells[(snake->tail + k) & (snake->capacity - 1)];
+      arena->occupied[cell / 64] &= ~(1ULL << (cell % 64));
+    }
+    arena->deaths += snake->length > 0;
+    arena_spawn_snake(arena, i);
+  }
+  arena->ticks++;
+}
+
+void *arena_thread(void *arg)
+{
+  ArenaThread *thread = arg;
+  Arena *arena = thread->arena;
+  ArenaWorker *worker = &arena->workers[thread->id];
+  for (long tick = 0; tick < arena->tick_limit; tick++)
+  {
+    arena_decide(arena, worker);
+    pthread_barrier_wait(&arena->barrier);
+    for (int band = thread->id; band < arena->tiles; band += arena->thread_count)
+      arena_resolve(arena, band);
+    pthread_barrier_wait(&arena->barrier);
+    arena_apply(arena, worker);
+    if (pthread_barrier_wait(&arena->barrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+      arena_bury(arena);
+    pthread_barrier_wait(&arena->barrier);
+  }
+  return NULL;
+}
+
+int run_arena_bench(int argc, char *argv[])
+{
+  int size = ARENA_SIZE;
+  int count = ARENA_SNAKES;
+  long ticks = ARENA_TICKS;
+  uint64_t seed = BENCH_SEED;
+  long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+      size = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--snakes") == 0 && i + 1 < argc)
+      count = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+      ticks = atol(argv[++i]);
+    else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+      threads = atol(argv[++i]);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+      seed = strtoull(argv[++i], NULL, 10);
+  }
+
+  Arena arena;
+  if (ticks < 1 || !arena_init(&arena, size, count, threads, seed))
+  {
+    fprintf(stderr, "Usage: %s --arena [--size N] [--snakes N] [--ticks N] [--threads N] [--seed N]\n", argv[0]);
+    fprintf(stderr, "       N for --size is a multiple of %d\n", ARENA_TILE);
+    return 1;
+  }
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  arena.tick_limit = ticks;
+  pthread_t handles[BATCH_MAX_THREADS];
+  ArenaThread args[BATCH_MAX_THREADS];
+  for (int t = 0; t < arena.thread_count; t++)
+  {
+    args[t] = (ArenaThread){&arena, t};
+    if (t > 0)
+      pthread_create(&handles[t], NULL, arena_thread, &args[t]);
+  }
+  arena_thread(&args[0]);
+  for (int t = 1; t < arena.thread_count; t++)
+    pthread_join(handles[t], NULL);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  long steps = 0;
+  long eaten = 0;
+  long length = 0;
+  int longest = 0;
+  for (int t = 0; t < arena.thread_count; t++)
+  {
+    steps += arena.workers[t].steps;
+    eaten += arena.workers[t].eaten;
+  }
+  for (int i = 0; i < count; i++)
+  {
+    length += arena.snakes[i].length;
+    if (arena.snakes[i].length > longest)
+      longest = arena.snakes[i].length;
+  }
+
+  double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  printf("{\"bench\":\"arena\",\"size\":%d,\"snakes\":%d,\"berries\":%d,\"threads\":%d,\"ticks\":%ld,\"seconds\":%.3f,"
+         "\"ticks_per_second\":%.1f,\"steps_per_second\":%.0f,\"eaten\":%ld,\"deaths\":%ld,\"mean_length\":%.1f,"
+         "\"max_length\":%d}\n",
+         size, count, arena.tiles * arena.tiles * ARENA_TILE_BERRIES, arena.thread_count, arena.ticks, seconds,
+         seconds > 0 ? arena.ticks / seconds : 0.0, seconds > 0 ? steps / seconds : 0.0, eaten, arena.deaths,
+         (double)length / count, longest);
+
+  arena_free(&arena);
+  return 0;
+}
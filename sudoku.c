@@ -1,12 +1,55 @@
 #include <curses.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <unistd.h>
 #include <time.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define SCREEN_WIDTH 25
 #define SCREEN_HEIGHT 13
+#define MAX_BOX 5
+#define MAX_SIZE (MAX_BOX * MAX_BOX)
+#define DLX_COUNT_BUDGET 1000
+#define BATCH_WINDOW 65536
+#define BATCH_BUFFER (BATCH_WINDOW * 128)
+#define BATCH_CHUNK 64
+#define BATCH_MAX_THREADS 256
+
+#define DIFFICULTY_EASY 0
+#define DIFFICULTY_MEDIUM 1
+#define DIFFICULTY_HARD 2
+#define DIFFICULTY_ATTEMPTS 500
+#define DLX_CHECK_BUDGET 20000
+#define SOLVABLE_NO 0
+#define SOLVABLE_YES 1
+#define SOLVABLE_UNKNOWN 2
+#define BANK_PATH "sudoku.bank"
+#define BANK_MAGIC "SDKBANK1"
+#define BANK_DEFAULT_COUNT 10000
+#define BENCH_SEED 12345
+#define BENCH_GENERATE 100
+#define BENCH_GENERATE_LARGE 3
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_CLONES __attribute__((target_clones("avx2", "sse4.1", "default")))
+#else
+#define SIMD_CLONES
+#endif
+
+static const char SYMBOLS[] = ".123456789ABCDEFGHIJKLMNOP";
+static const char *DIFFICULTY_NAMES[] = {"Fácil", "Médio", "Difícil"};
+static const char *SOLVABLE_NAMES[] = {"não", "sim", "?"};
+static const char *BENCH_SETS[] = {"puzzles/classic.txt", "puzzles/guess.txt", "puzzles/hard.txt"};
+static const char *TECHNIQUE_NAMES[] = {
+    "", "candidato único", "posição única", "par nu", "par escondido",
+    "apontamento", "redução caixa-linha", "X-wing", "solução"};
 
 typedef struct
 {
@@ -14,38 +57,272 @@ typedef struct
   int y;
 } vec2;
 
+typedef enum
+{
+  TECH_NONE,
+  TECH_NAKED_SINGLE,
+  TECH_HIDDEN_SINGLE,
+  TECH_NAKED_PAIR,
+  TECH_HIDDEN_PAIR,
+  TECH_POINTING,
+  TECH_BOX_LINE,
+  TECH_X_WING,
+  TECH_GUESS
+} Technique;
+
+typedef struct
+{
+  int board[81];
+  uint16_t candidates[81];
+  uint8_t counts[27][9];
+  uint16_t placed[27];
+  int empty;
+  bool broken;
+  int last_cell;
+  int last_digit;
+} Logic;
+
 typedef struct
 {
   vec2 cursor;
-  int board[9][9];
-  int solution[9][9];
-  bool fixed[9][9];
+  int box;
+  int size;
+  int difficulty;
+  int board[MAX_SIZE][MAX_SIZE];
+  int solution[MAX_SIZE][MAX_SIZE];
+  bool fixed[MAX_SIZE][MAX_SIZE];
+  int counts[3][MAX_SIZE][MAX_SIZE + 1];
+  int correct;
+  int conflicts;
+  int witness[MAX_SIZE][MAX_SIZE];
+  int filled;
+  int witness_matches;
+  int solvable;
+  bool solvable_dirty;
+  Logic logic;
+  bool logic_valid;
+  char message[96];
 } GameState;
 
-void init_game_state(GameState *state);
+typedef struct
+{
+  int box;
+  int size;
+  int columns;
+  int rows_base;
+  int *left;
+  int *right;
+  int *up;
+  int *down;
+  int *column;
+  int *count;
+  long budget;
+} Dlx;
+
+typedef uint16_t lanes16 __attribute__((vector_size(32)));
+
+typedef struct
+{
+  _Alignas(32) uint16_t cells[9][16];
+} Grid;
+
+typedef struct
+{
+  long nodes;
+  long guesses;
+  long backtracks;
+} SearchStats;
+
+static int UNITS[27][9];
+static int CELL_UNITS[81][3];
+static int PEERS[81][20];
+static bool tables_ready = false;
+
+typedef struct
+{
+  char magic[8];
+  uint32_t record_size;
+  uint32_t counts[3];
+  uint32_t offsets[3];
+} BankHeader;
+
+typedef struct
+{
+  uint8_t solution[41];
+  uint8_t givens[11];
+  uint8_t technique;
+} BankRecord;
+
+typedef struct
+{
+  const uint8_t *data;
+  size_t size;
+  const BankHeader *header;
+  const BankRecord *records;
+} Bank;
+
+typedef struct
+{
+  const char *data;
+  size_t size;
+  size_t offset;
+  FILE *stream;
+  char *buffer;
+  bool mapped;
+  bool eof;
+} BatchReader;
+
+typedef struct
+{
+  atomic_int next;
+  int end;
+} BatchQueue;
+
+typedef struct
+{
+  const char **lines;
+  size_t *lengths;
+  char *output;
+  int count;
+  int threads;
+  BatchQueue queues[BATCH_MAX_THREADS];
+  atomic_long unsolved;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  pthread_cond_t done;
+  int job;
+  int active;
+  bool stop;
+} BatchWindow;
+
+typedef struct
+{
+  BatchWindow *window;
+  int id;
+} BatchWorker;
+
+void init_game_state(GameState *state, int box, int difficulty);
 void game_loop(GameState *state, WINDOW *win);
 void handle_input(GameState *state, WINDOW *win);
 void draw_table(GameState *state);
+int choose_box(WINDOW *win);
+int choose_difficulty(WINDOW *win);
 bool is_valid(GameState *state, int num, int row, int col);
 bool is_winner(GameState *state);
-bool solve_sudoku(int board[9][9], int row, int col);
-vec2 cursor_to_cell(vec2 cursor);
+void set_cell(GameState *state, int row, int col, int num);
+void reset_counts(GameState *state);
+int check_solvable(GameState *state);
+void give_hint(GameState *state);
+bool find_logic_hint(GameState *state, int *cell, int *num, Technique *technique);
+bool find_single_hint(GameState *state, int *cell, int *num);
+bool solve_sudoku(int board[9][9]);
+int count_solutions(int board[9][9], int limit);
+bool solve_grid(int box, int board[MAX_SIZE][MAX_SIZE]);
+int count_grid_solutions(int box, int board[MAX_SIZE][MAX_SIZE], int limit);
+void dlx_init(Dlx *dlx, int box);
+void dlx_reset(Dlx *dlx);
+void dlx_free(Dlx *dlx);
+void dlx_cover(Dlx *dlx, int col);
+void dlx_uncover(Dlx *dlx, int col);
+bool dlx_load(Dlx *dlx, int board[MAX_SIZE][MAX_SIZE]);
+int dlx_search(Dlx *dlx, int limit, bool randomize, int board[MAX_SIZE][MAX_SIZE]);
+void dig_puzzle(GameState *state);
+bool grid_load(Grid *grid, int board[9][9]);
+void grid_store(Grid *grid, int board[9][9]);
+int grid_search(Grid *grid, int limit, bool randomize, Grid *solution);
+int propagate_scalar(Grid *grid);
+int propagate_vector(Grid *grid);
+void init_tables(void);
+bool logic_init(Logic *logic, int board[9][9]);
+void logic_eliminate(Logic *logic, int cell, int digit);
+void logic_place(Logic *logic, int cell, int digit);
+bool find_naked_single(Logic *logic);
+bool find_hidden_single(Logic *logic);
+bool find_naked_pair(Logic *logic);
+uint16_t digit_positions(Logic *logic, int unit, int digit);
+bool find_hidden_pair(Logic *logic);
+bool eliminate_outside(Logic *logic, int unit, int digit, int keep_unit);
+bool find_pointing(Logic *logic);
+bool find_box_line(Logic *logic);
+bool find_x_wing(Logic *logic);
+Technique logic_step(Logic *logic);
+Technique rate_puzzle(int board[9][9]);
+int technique_difficulty(Technique technique);
+vec2 cell_to_screen(GameState *state, vec2 cell);
+int run_batch(const char *path);
+bool batch_open(BatchReader *reader, const char *path);
+void batch_close(BatchReader *reader);
+int batch_next_window(BatchReader *reader, const char **lines, size_t *lengths);
+void *batch_worker(void *arg);
+void batch_drain(BatchWindow *window, int id);
+bool solve_line(const char *line, size_t length, char *out);
+bool bank_open(Bank *bank, const char *path);
+bool bank_pick(const Bank *bank, GameState *state, int difficulty);
+void bank_pack(BankRecord *record, int board[9][9], int solution[9][9], Technique technique);
+int build_bank(const char *path, int count);
+int run_bench(int argc, char **argv);
+int bench_load(const char *path, int (**boards)[9][9]);
+void bench_report(const char *bench, const char *set, double *latencies, int count, int failed, SearchStats *stats);
+int compare_latency(const void *a, const void *b);
+
+static int (*propagate)(Grid *grid) = propagate_vector;
+static Bank bank;
+static _Thread_local SearchStats search_stats;
 
-int main(void)
+int main(int argc, char **argv)
 {
+  const char *path = NULL;
+  int count = BANK_DEFAULT_COUNT;
+  bool batch = false;
+  bool build = false;
+  bool bench = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--batch") == 0)
+      batch = true;
+    else if (strcmp(argv[i], "--build-bank") == 0)
+      build = true;
+    else if (strcmp(argv[i], "--bench") == 0)
+      bench = true;
+    else if (strcmp(argv[i], "--scalar") == 0)
+      propagate = propagate_scalar;
+    else if (path == NULL)
+      path = argv[i];
+    else
+      count = atoi(argv[i]);
+  }
+
+  if (batch)
+    return run_batch(path);
+  if (bench)
+    return run_bench(argc, argv);
+
   srand(time(NULL));
 
+  if (build)
+    return build_bank(path != NULL ? path : BANK_PATH, count);
+
+  const char *bank_path = getenv("SUDOKU_BANK");
+  bank_open(&bank, bank_path != NULL ? bank_path : BANK_PATH);
+
   WINDOW *win = initscr();
   keypad(win, true);
   nodelay(win, true);
   curs_set(0);
   noecho();
 
+  if (has_colors())
+  {
+    start_color();
+    init_pair(1, COLOR_RED, COLOR_BLACK);
+  }
+
   GameState state;
 
   while (true)
   {
-    init_game_state(&state);
+    int box = choose_box(win);
+    init_game_state(&state, box, box == 3 ? choose_difficulty(win) : DIFFICULTY_HARD);
     game_loop(&state, win);
 
     nodelay(win, false);
@@ -72,328 +349,2076 @@ int main(void)
   }
 }
 
-void init_game_state(GameState *state)
+int choose_box(WINDOW *win)
 {
-  memset(state->board, 0, sizeof(state->board));
-  memset(state->solution, 0, sizeof(state->solution));
-  memset(state->fixed, false, sizeof(state->fixed));
+  nodelay(win, false);
+  erase();
+  mvprintw(SCREEN_HEIGHT / 2 - 2, 2, "Escolha o tamanho do tabuleiro:");
+  mvprintw(SCREEN_HEIGHT / 2, 4, "1 - 9x9");
+  mvprintw(SCREEN_HEIGHT / 2 + 1, 4, "2 - 16x16");
+  mvprintw(SCREEN_HEIGHT / 2 + 2, 4, "3 - 25x25");
+  mvprintw(SCREEN_HEIGHT / 2 + 4, 2, "Gerar o tabuleiro pode levar alguns segundos");
+  refresh();
+
+  int box = 0;
+  while (box == 0)
+  {
+    int pressed = wgetch(win);
+    if (pressed == '1')
+      box = 3;
+    else if (pressed == '2')
+      box = 4;
+    else if (pressed == '3')
+      box = 5;
+    else if (pressed == 27)
+    {
+      endwin();
+      exit(0);
+    }
+  }
 
-  state->cursor.x = 2;
-  state->cursor.y = 1;
+  nodelay(win, true);
+  return box;
+}
 
-  solve_sudoku(state->solution, 0, 0);
+int choose_difficulty(WINDOW *win)
+{
+  nodelay(win, false);
+  erase();
+  mvprintw(SCREEN_HEIGHT / 2 - 2, 2, "Escolha a dificuldade:");
+  for (int i = DIFFICULTY_EASY; i <= DIFFICULTY_HARD; i++)
+    mvprintw(SCREEN_HEIGHT / 2 + i, 4, "%d - %s", i + 1, DIFFICULTY_NAMES[i]);
+  refresh();
 
-  for (int row = 0; row < 9; row++)
+  int difficulty = -1;
+  while (difficulty < 0)
   {
-    for (int col = 0; col < 9; col++)
+    int pressed = wgetch(win);
+    if (pressed >= '1' && pressed <= '3')
+      difficulty = pressed - '1';
+    else if (pressed == 27)
     {
-      if ((rand() % 100) < 40)
-      {
-        state->board[row][col] = state->solution[row][col];
-        state->fixed[row][col] = true;
-      }
-      else
-      {
-        state->board[row][col] = 0;
-        state->fixed[row][col] = false;
-      }
+      endwin();
+      exit(0);
     }
   }
+
+  nodelay(win, true);
+  return difficulty;
 }
 
-bool solve_sudoku(int board[9][9], int row, int col)
+void init_game_state(GameState *state, int box, int difficulty)
 {
-  if (row == 9)
-    return true;
-  if (col == 9)
-    return solve_sudoku(board, row + 1, 0);
-  if (board[row][col] != 0)
-    return solve_sudoku(board, row, col + 1);
+  state->box = box;
+  state->size = box * box;
+  state->difficulty = difficulty;
 
-  int nums[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
-  for (int i = 0; i < 9; i++)
+  state->cursor.x = 0;
+  state->cursor.y = 0;
+
+  if (box == 3 && bank_pick(&bank, state, difficulty))
   {
-    int j = rand() % 9;
-    int temp = nums[i];
-    nums[i] = nums[j];
-    nums[j] = temp;
+    reset_counts(state);
+    return;
   }
 
-  for (int i = 0; i < 9; i++)
+  for (int attempt = 0; attempt < DIFFICULTY_ATTEMPTS; attempt++)
   {
-    int num = nums[i];
-
-    bool valid = true;
-    for (int c = 0; c < 9; c++)
-    {
-      if (board[row][c] == num)
-      {
-        valid = false;
-        break;
-      }
-    }
-    if (!valid)
-      continue;
-
-    for (int r = 0; r < 9; r++)
-    {
-      if (board[r][col] == num)
-      {
-        valid = false;
-        break;
-      }
-    }
-    if (!valid)
-      continue;
+    memset(state->solution, 0, sizeof(state->solution));
+    solve_grid(box, state->solution);
+    dig_puzzle(state);
 
-    int start_row = (row / 3) * 3;
-    int start_col = (col / 3) * 3;
-    for (int r = 0; r < 3; r++)
-    {
-      for (int c = 0; c < 3; c++)
-      {
-        if (board[start_row + r][start_col + c] == num)
-        {
-          valid = false;
-          break;
-        }
-      }
-      if (!valid)
-        break;
-    }
-    if (!valid)
-      continue;
+    if (box != 3)
+      break;
 
-    board[row][col] = num;
-    if (solve_sudoku(board, row, col + 1))
-      return true;
-    board[row][col] = 0;
+    int board[9][9];
+    for (int row = 0; row < 9; row++)
+      memcpy(board[row], state->board[row], sizeof(board[row]));
+    if (technique_difficulty(rate_puzzle(board)) == difficulty)
+      break;
   }
-  return false;
+
+  reset_counts(state);
 }
 
-bool is_valid(GameState *state, int num, int row, int col)
+void dig_puzzle(GameState *state)
 {
-  for (int c = 0; c < 9; c++)
+  int size = state->size;
+  int cells = size * size;
+
+  memcpy(state->board, state->solution, sizeof(state->board));
+
+  int order[MAX_SIZE * MAX_SIZE];
+  for (int i = 0; i < cells; i++)
+    order[i] = i;
+  for (int i = cells - 1; i > 0; i--)
   {
-    if (c != col && state->board[row][c] == num)
-    {
-      return false;
-    }
+    int j = rand() % (i + 1);
+    int temp = order[i];
+    order[i] = order[j];
+    order[j] = temp;
   }
 
-  for (int r = 0; r < 9; r++)
+  for (int i = 0; i < cells; i++)
   {
-    if (r != row && state->board[r][col] == num)
-    {
-      return false;
-    }
+    int row = order[i] / size;
+    int col = order[i] % size;
+    int num = state->board[row][col];
+
+    state->board[row][col] = 0;
+    if (count_grid_solutions(state->box, state->board, 2) != 1)
+      state->board[row][col] = num;
   }
 
-  int start_row = (row / 3) * 3;
-  int start_col = (col / 3) * 3;
-  for (int r = 0; r < 3; r++)
+  for (int row = 0; row < size; row++)
   {
-    for (int c = 0; c < 3; c++)
-    {
-      int curr_row = start_row + r;
-      int curr_col = start_col + c;
-      if ((curr_row != row || curr_col != col) && state->board[curr_row][curr_col] == num)
-      {
-        return false;
-      }
-    }
+    for (int col = 0; col < size; col++)
+      state->fixed[row][col] = state->board[row][col] != 0;
   }
-
-  return true;
 }
 
-vec2 cursor_to_cell(vec2 cursor)
+bool solve_sudoku(int board[9][9])
 {
-  vec2 cell;
-  cell.x = (cursor.x - 2) / 2;
-  if (cursor.x > 8)
-    cell.x--;
-  if (cursor.x > 16)
-    cell.x--;
-
-  cell.y = cursor.y - 1;
-  if (cursor.y > 4)
-    cell.y--;
-  if (cursor.y > 8)
-    cell.y--;
+  Grid grid;
+  Grid solution;
+  if (!grid_load(&grid, board) || grid_search(&grid, 1, true, &solution) != 1)
+    return false;
 
-  return cell;
+  grid_store(&solution, board);
+  return true;
 }
 
-void game_loop(GameState *state, WINDOW *win)
+int count_solutions(int board[9][9], int limit)
 {
-  while (!is_winner(state))
-  {
-    handle_input(state, win);
-
-    erase();
-    draw_table(state);
-    mvprintw(SCREEN_HEIGHT - 1, 0, "Use setas para mover | 1-9 inserir | 0/DEL para apagar | ESC para sair");
-    refresh();
-    usleep(50000);
-  }
+  Grid grid;
+  if (!grid_load(&grid, board))
+    return 0;
+  return grid_search(&grid, limit, false, NULL);
 }
 
-bool is_winner(GameState *state)
+bool grid_load(Grid *grid, int board[9][9])
 {
-  for (int x = 0; x < 9; x++)
+  memset(grid, 0, sizeof(*grid));
+  for (int row = 0; row < 9; row++)
   {
-    for (int y = 0; y < 9; y++)
+    for (int col = 0; col < 9; col++)
     {
-      if (state->solution[x][y] != state->board[x][y])
+      int num = board[row][col];
+      if (num < 0 || num > 9)
         return false;
+      grid->cells[row][col] = num == 0 ? 0x1FF : 1 << (num - 1);
     }
   }
-
   return true;
 }
 
-void handle_input(GameState *state, WINDOW *win)
+void grid_store(Grid *grid, int board[9][9])
 {
-  int pressed = wgetch(win);
-
-  if (pressed == KEY_UP)
+  for (int row = 0; row < 9; row++)
   {
-    state->cursor.y--;
-    if (state->cursor.y <= 0)
-      state->cursor.y = 11;
-    if (state->cursor.y == 4)
-      state->cursor.y = 3;
-    if (state->cursor.y == 8)
-      state->cursor.y = 7;
+    for (int col = 0; col < 9; col++)
+      board[row][col] = __builtin_ctz(grid->cells[row][col]) + 1;
   }
-  else if (pressed == KEY_DOWN)
+}
+
+int grid_search(Grid *grid, int limit, bool randomize, Grid *solution)
+{
+  search_stats.nodes++;
+  int unsolved = propagate(grid);
+  if (unsolved < 0)
+    return 0;
+  if (unsolved == 0)
   {
-    state->cursor.y++;
-    if (state->cursor.y >= 12)
-      state->cursor.y = 1;
-    if (state->cursor.y == 4)
-      state->cursor.y = 5;
-    if (state->cursor.y == 8)
-      state->cursor.y = 9;
+    if (solution != NULL)
+      *solution = *grid;
+    return 1;
   }
-  else if (pressed == KEY_RIGHT)
+
+  int best_row = 0;
+  int best_col = 0;
+  int best_count = 10;
+  for (int row = 0; row < 9 && best_count > 2; row++)
   {
-    state->cursor.x += 2;
-    if (state->cursor.x >= 24)
-      state->cursor.x = 2;
-    if (state->cursor.x == 8)
-      state->cursor.x = 10;
-    if (state->cursor.x == 16)
-      state->cursor.x = 18;
+    for (int col = 0; col < 9; col++)
+    {
+      int count = __builtin_popcount(grid->cells[row][col]);
+      if (count > 1 && count < best_count)
+      {
+        best_row = row;
+        best_col = col;
+        best_count = count;
+        if (count == 2)
+          break;
+      }
+    }
   }
-  else if (pressed == KEY_LEFT)
+
+  uint16_t mask = grid->cells[best_row][best_col];
+  uint16_t bits[9];
+  int count = 0;
+  while (mask)
   {
-    state->cursor.x -= 2;
-    if (state->cursor.x <= 0)
-      state->cursor.x = 22;
-    if (state->cursor.x == 8)
-      state->cursor.x = 6;
-    if (state->cursor.x == 16)
-      state->cursor.x = 14;
+    bits[count++] = mask & -mask;
+    mask &= mask - 1;
   }
 
-  vec2 cell = cursor_to_cell(state->cursor);
-  if (cell.x >= 0 && cell.x < 9 && cell.y >= 0 && cell.y < 9)
+  if (randomize)
   {
-    if (!state->fixed[cell.y][cell.x])
+    for (int i = count - 1; i > 0; i--)
     {
-      if (pressed >= '1' && pressed <= '9')
-      {
-        int num = pressed - '0';
-        if (is_valid(state, num, cell.y, cell.x))
-        {
-          state->board[cell.y][cell.x] = num;
-        }
-      }
-      else if (pressed == '0' || pressed == KEY_BACKSPACE || pressed == KEY_DC)
-      {
-        state->board[cell.y][cell.x] = 0;
-      }
+      int j = rand() % (i + 1);
+      uint16_t temp = bits[i];
+      bits[i] = bits[j];
+      bits[j] = temp;
     }
   }
 
-  if (pressed == 27)
+  int found = 0;
+  for (int i = 0; i < count && found < limit; i++)
   {
-    endwin();
-    exit(0);
+    Grid child = *grid;
+    child.cells[best_row][best_col] = bits[i];
+    int result = grid_search(&child, limit - found, randomize, solution);
+    search_stats.guesses++;
+    search_stats.backtracks += result == 0;
+    found += result;
   }
+  return found;
 }
 
-void draw_table(GameState *state)
+int propagate_scalar(Grid *grid)
 {
-  for (int row = 0; row <= 3; row++)
+  while (true)
   {
-    int y = row * 4;
-    for (int x = 0; x <= 24; x++)
+    uint16_t used[27] = {0};
+    uint16_t once[27] = {0};
+    uint16_t twice[27] = {0};
+
+    for (int row = 0; row < 9; row++)
     {
-      if (x % 8 == 0 || x == 24)
+      for (int col = 0; col < 9; col++)
       {
-        mvaddch(y, x, '+');
+        uint16_t x = grid->cells[row][col];
+        if (x == 0)
+          return -1;
+
+        int units[3] = {row, 9 + col, 18 + (row / 3) * 3 + col / 3};
+        bool single = (x & (x - 1)) == 0;
+
+        for (int i = 0; i < 3; i++)
+        {
+          if (single)
+          {
+            if (used[units[i]] & x)
+              return -1;
+            used[units[i]] |= x;
+          }
+          twice[units[i]] |= once[units[i]] & x;
+          once[units[i]] |= x;
+        }
       }
-      else
+    }
+
+    for (int unit = 0; unit < 27; unit++)
+    {
+      if (once[unit] != 0x1FF)
+        return -1;
+    }
+
+    bool changed = false;
+    int unsolved = 0;
+    for (int row = 0; row < 9; row++)
+    {
+      for (int col = 0; col < 9; col++)
       {
-        mvaddch(y, x, '-');
+        uint16_t x = grid->cells[row][col];
+        if ((x & (x - 1)) == 0)
+          continue;
+
+        int units[3] = {row, 9 + col, 18 + (row / 3) * 3 + col / 3};
+        uint16_t hidden = 0;
+        for (int i = 0; i < 3; i++)
+        {
+          x &= ~used[units[i]];
+          hidden |= once[units[i]] & ~twice[units[i]];
+        }
+        hidden &= x;
+
+        if (hidden != 0)
+        {
+          if ((hidden & (hidden - 1)) != 0)
+            return -1;
+          x = hidden;
+        }
+        if (x == 0)
+          return -1;
+
+        changed |= x != grid->cells[row][col];
+        unsolved += (x & (x - 1)) != 0;
+        grid->cells[row][col] = x;
       }
     }
+
+    if (!changed)
+      return unsolved;
   }
+}
+
+static inline void tally(lanes16 *once, lanes16 *twice, const lanes16 *x)
+{
+  *twice |= *once & *x;
+  *once |= *x;
+}
 
-  for (int col = 0; col <= 3; col++)
+static inline void reduce_lanes(lanes16 *once, lanes16 *twice)
+{
+  const lanes16 xor8 = {8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7};
+  const lanes16 xor4 = {4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11};
+  const lanes16 xor2 = {2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13};
+  const lanes16 xor1 = {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14};
+  lanes16 other;
+
+  other = __builtin_shuffle(*once, xor8);
+  *twice |= __builtin_shuffle(*twice, xor8) | (*once & other);
+  *once |= other;
+  other = __builtin_shuffle(*once, xor4);
+  *twice |= __builtin_shuffle(*twice, xor4) | (*once & other);
+  *once |= other;
+  other = __builtin_shuffle(*once, xor2);
+  *twice |= __builtin_shuffle(*twice, xor2) | (*once & other);
+  *once |= other;
+  other = __builtin_shuffle(*once, xor1);
+  *twice |= __builtin_shuffle(*twice, xor1) | (*once & other);
+  *once |= other;
+}
+
+static inline void reduce_boxes(lanes16 *once, lanes16 *twice)
+{
+  const lanes16 box0 = {0, 0, 0, 3, 3, 3, 6, 6, 6, 9, 10, 11, 12, 13, 14, 15};
+  const lanes16 box1 = {1, 1, 1, 4, 4, 4, 7, 7, 7, 9, 10, 11, 12, 13, 14, 15};
+  const lanes16 box2 = {2, 2, 2, 5, 5, 5, 8, 8, 8, 9, 10, 11, 12, 13, 14, 15};
+
+  lanes16 once0 = __builtin_shuffle(*once, box0);
+  lanes16 once1 = __builtin_shuffle(*once, box1);
+  lanes16 once2 = __builtin_shuffle(*once, box2);
+  *twice = __builtin_shuffle(*twice, box0) | __builtin_shuffle(*twice, box1) | __builtin_shuffle(*twice, box2) |
+           (once0 & once1) | (once0 & once2) | (once1 & once2);
+  *once = once0 | once1 | once2;
+}
+
+static inline bool any_lane(const lanes16 *v)
+{
+  uint64_t words[4];
+  memcpy(words, v, sizeof(words));
+  return (words[0] | words[1] | words[2] | words[3]) != 0;
+}
+
+SIMD_CLONES int propagate_vector(Grid *grid)
+{
+  const lanes16 valid = {0x1FF, 0x1FF, 0x1FF, 0x1FF, 0x1FF, 0x1FF, 0x1FF, 0x1FF, 0x1FF};
+
+  lanes16 rows[9];
+  memcpy(rows, grid->cells, sizeof(rows));
+
+  while (true)
   {
-    int x = col * 8;
-    for (int y = 1; y < 12; y++)
+    lanes16 singles[9];
+    lanes16 col_used = {0};
+    lanes16 col_dup = {0};
+    lanes16 col_once = {0};
+    lanes16 col_twice = {0};
+    lanes16 broken = {0};
+    lanes16 used[9];
+    lanes16 exactly[9];
+
+    for (int row = 0; row < 9; row++)
     {
-      if (y == 4 || y == 8)
-        continue;
-      mvaddch(y, x, '|');
+      lanes16 x = rows[row];
+      singles[row] = x & (lanes16)((x & (x - 1)) == 0);
+      tally(&col_used, &col_dup, &singles[row]);
+      tally(&col_once, &col_twice, &x);
     }
-  }
 
-  for (int row = 0; row < 9; row++)
-  {
-    for (int col = 0; col < 9; col++)
+    for (int band = 0; band < 3; band++)
     {
-      int screen_x = col * 2 + 2;
-      int screen_y = row + 1;
-
-      if (col >= 3)
-        screen_x += 2;
-      if (col >= 6)
-        screen_x += 2;
-      if (row >= 3)
-        screen_y += 1;
-      if (row >= 6)
-        screen_y += 1;
-
-      if (state->cursor.x == screen_x && state->cursor.y == screen_y)
+      lanes16 box_used = {0};
+      lanes16 box_dup = {0};
+      lanes16 box_once = {0};
+      lanes16 box_twice = {0};
+      for (int row = band * 3; row < band * 3 + 3; row++)
       {
-        attron(A_REVERSE);
+        tally(&box_used, &box_dup, &singles[row]);
+        tally(&box_once, &box_twice, &rows[row]);
       }
+      reduce_boxes(&box_used, &box_dup);
+      reduce_boxes(&box_once, &box_twice);
 
-      if (state->board[row][col] == 0)
-      {
-        mvaddch(screen_y, screen_x, '.');
-      }
-      else
+      broken |= box_dup | (box_once ^ valid);
+
+      for (int row = band * 3; row < band * 3 + 3; row++)
       {
-        if (state->fixed[row][col])
-        {
-          attron(A_BOLD);
-        }
-        mvprintw(screen_y, screen_x, "%d", state->board[row][col]);
-        if (state->fixed[row][col])
-        {
-          attroff(A_BOLD);
-        }
+        lanes16 row_used = singles[row];
+        lanes16 row_dup = {0};
+        lanes16 row_once = rows[row];
+        lanes16 row_twice = {0};
+        reduce_lanes(&row_used, &row_dup);
+        reduce_lanes(&row_once, &row_twice);
+
+        broken |= row_dup | ((row_once ^ valid) & valid);
+        used[row] = row_used | box_used | col_used;
+        exactly[row] = (row_once & ~row_twice) | (box_once & ~box_twice) | (col_once & ~col_twice);
       }
+    }
 
-      attroff(A_REVERSE);
+    broken |= col_dup | (col_once ^ valid);
+
+    lanes16 changed = {0};
+    lanes16 unsolved = {0};
+    for (int row = 0; row < 9; row++)
+    {
+      lanes16 x = rows[row];
+      lanes16 multi = (lanes16)((x & (x - 1)) != 0);
+      lanes16 next = x & ~used[row];
+      lanes16 hidden = next & exactly[row];
+      lanes16 has_hidden = (lanes16)(hidden != 0);
+
+      broken |= multi & has_hidden & (lanes16)((hidden & (hidden - 1)) != 0);
+      next = (has_hidden & hidden) | (~has_hidden & next);
+      next = (multi & next) | (~multi & x);
+      broken |= valid & (lanes16)(next == 0);
+
+      changed |= next ^ x;
+      unsolved -= (lanes16)((next & (next - 1)) != 0);
+      rows[row] = next;
+    }
+
+    if (any_lane(&broken))
+      return -1;
+
+    if (!any_lane(&changed))
+    {
+      memcpy(grid->cells, rows, sizeof(rows));
+      int count = 0;
+      for (int i = 0; i < 16; i++)
+        count += unsolved[i];
+      return count;
     }
   }
 }
+
+bool solve_grid(int box, int board[MAX_SIZE][MAX_SIZE])
+{
+  if (box == 3)
+  {
+    int small[9][9];
+    for (int row = 0; row < 9; row++)
+      memcpy(small[row], board[row], sizeof(small[row]));
+    if (!solve_sudoku(small))
+      return false;
+    for (int row = 0; row < 9; row++)
+      memcpy(board[row], small[row], sizeof(small[row]));
+    return true;
+  }
+
+  Dlx dlx;
+  dlx_init(&dlx, box);
+  bool solved = dlx_load(&dlx, board) && dlx_search(&dlx, 1, true, board) == 1;
+  dlx_free(&dlx);
+  return solved;
+}
+
+int count_grid_solutions(int box, int board[MAX_SIZE][MAX_SIZE], int limit)
+{
+  if (box == 3)
+  {
+    int small[9][9];
+    for (int row = 0; row < 9; row++)
+      memcpy(small[row], board[row], sizeof(small[row]));
+    return count_solutions(small, limit);
+  }
+
+  Dlx dlx;
+  dlx_init(&dlx, box);
+  dlx.budget = DLX_COUNT_BUDGET;
+  int found = dlx_load(&dlx, board) ? dlx_search(&dlx, limit, false, NULL) : 0;
+  dlx_free(&dlx);
+  return found;
+}
+
+void dlx_init(Dlx *dlx, int box)
+{
+  int size = box * box;
+  int nodes = 1 + 4 * size * size + 4 * size * size * size;
+
+  dlx->box = box;
+  dlx->size = size;
+  dlx->columns = 4 * size * size;
+  dlx->rows_base = 1 + dlx->columns;
+  dlx->left = malloc(nodes * sizeof(int));
+  dlx->right = malloc(nodes * sizeof(int));
+  dlx->up = malloc(nodes * sizeof(int));
+  dlx->down = malloc(nodes * sizeof(int));
+  dlx->column = malloc(nodes * sizeof(int));
+  dlx->count = malloc((dlx->columns + 1) * sizeof(int));
+  dlx->budget = -1;
+
+  dlx_reset(dlx);
+}
+
+void dlx_reset(Dlx *dlx)
+{
+  int size = dlx->size;
+  int cells = size * size;
+
+  for (int col = 0; col <= dlx->columns; col++)
+  {
+    dlx->left[col] = col == 0 ? dlx->columns : col - 1;
+    dlx->right[col] = col == dlx->columns ? 0 : col + 1;
+    dlx->up[col] = col;
+    dlx->down[col] = col;
+    dlx->column[col] = col;
+    dlx->count[col] = 0;
+  }
+
+  int node = dlx->rows_base;
+  for (int row = 0; row < size; row++)
+  {
+    for (int col = 0; col < size; col++)
+    {
+      int box_index = (row / dlx->box) * dlx->box + col / dlx->box;
+      for (int digit = 0; digit < size; digit++)
+      {
+        int headers[4] = {
+            1 + row * size + col,
+            1 + cells + row * size + digit,
+            1 + 2 * cells + col * size + digit,
+            1 + 3 * cells + box_index * size + digit};
+
+        for (int k = 0; k < 4; k++)
+        {
+          int header = headers[k];
+          dlx->column[node + k] = header;
+          dlx->left[node + k] = node + (k + 3) % 4;
+          dlx->right[node + k] = node + (k + 1) % 4;
+          dlx->up[node + k] = dlx->up[header];
+          dlx->down[node + k] = header;
+          dlx->down[dlx->up[header]] = node + k;
+          dlx->up[header] = node + k;
+          dlx->count[header]++;
+        }
+        node += 4;
+      }
+    }
+  }
+}
+
+void dlx_free(Dlx *dlx)
+{
+  free(dlx->left);
+  free(dlx->right);
+  free(dlx->up);
+  free(dlx->down);
+  free(dlx->column);
+  free(dlx->count);
+}
+
+void dlx_cover(Dlx *dlx, int col)
+{
+  dlx->right[dlx->left[col]] = dlx->right[col];
+  dlx->left[dlx->right[col]] = dlx->left[col];
+
+  for (int i = dlx->down[col]; i != col; i = dlx->down[i])
+  {
+    for (int j = dlx->right[i]; j != i; j = dlx->right[j])
+    {
+      dlx->down[dlx->up[j]] = dlx->down[j];
+      dlx->up[dlx->down[j]] = dlx->up[j];
+      dlx->count[dlx->column[j]]--;
+    }
+  }
+}
+
+void dlx_uncover(Dlx *dlx, int col)
+{
+  for (int i = dlx->up[col]; i != col; i = dlx->up[i])
+  {
+    for (int j = dlx->left[i]; j != i; j = dlx->left[j])
+    {
+      dlx->count[dlx->column[j]]++;
+      dlx->down[dlx->up[j]] = j;
+      dlx->up[dlx->down[j]] = j;
+    }
+  }
+
+  dlx->right[dlx->left[col]] = col;
+  dlx->left[dlx->right[col]] = col;
+}
+
+bool dlx_load(Dlx *dlx, int board[MAX_SIZE][MAX_SIZE])
+{
+  int size = dlx->size;
+
+  for (int row = 0; row < size; row++)
+  {
+    for (int col = 0; col < size; col++)
+    {
+      if (board[row][col] == 0)
+        continue;
+
+      int node = dlx->rows_base + 4 * ((row * size + col) * size + board[row][col] - 1);
+      for (int k = 0; k < 4; k++)
+      {
+        int header = dlx->column[node + k];
+        if (dlx->right[dlx->left[header]] != header)
+          return false;
+      }
+      for (int k = 0; k < 4; k++)
+        dlx_cover(dlx, dlx->column[node + k]);
+    }
+  }
+
+  return true;
+}
+
+int dlx_search(Dlx *dlx, int limit, bool randomize, int board[MAX_SIZE][MAX_SIZE])
+{
+  search_stats.nodes++;
+  if (dlx->right[0] == 0)
+    return 1;
+  if (dlx->budget == 0)
+    return limit;
+  if (dlx->budget > 0)
+    dlx->budget--;
+
+  int best = dlx->right[0];
+  for (int col = dlx->right[best]; col != 0; col = dlx->right[col])
+  {
+    if (dlx->count[col] < dlx->count[best])
+      best = col;
+  }
+
+  if (dlx->count[best] == 0)
+    return 0;
+
+  int rows[MAX_SIZE];
+  int count = 0;
+  for (int i = dlx->down[best]; i != best; i = dlx->down[i])
+    rows[count++] = i;
+
+  if (randomize)
+  {
+    for (int i = count - 1; i > 0; i--)
+    {
+      int j = rand() % (i + 1);
+      int temp = rows[i];
+      rows[i] = rows[j];
+      rows[j] = temp;
+    }
+  }
+
+  int found = 0;
+  dlx_cover(dlx, best);
+
+  for (int i = 0; i < count && found < limit; i++)
+  {
+    int node = rows[i];
+    for (int j = dlx->right[node]; j != node; j = dlx->right[j])
+      dlx_cover(dlx, dlx->column[j]);
+
+    int result = dlx_search(dlx, limit - found, randomize, board);
+    if (count > 1)
+    {
+      search_stats.guesses++;
+      search_stats.backtracks += result == 0;
+    }
+    if (result > 0 && board != NULL && found == 0)
+    {
+      int id = (node - dlx->rows_base) / 4;
+      board[id / (dlx->size * dlx->size)][(id / dlx->size) % dlx->size] = id % dlx->size + 1;
+    }
+    found += result;
+
+    for (int j = dlx->left[node]; j != node; j = dlx->left[j])
+      dlx_uncover(dlx, dlx->column[j]);
+  }
+
+  dlx_uncover(dlx, best);
+  return found;
+}
+
+void init_tables(void)
+{
+  if (tables_ready)
+    return;
+
+  for (int i = 0; i < 9; i++)
+  {
+    for (int j = 0; j < 9; j++)
+    {
+      UNITS[i][j] = i * 9 + j;
+      UNITS[9 + i][j] = j * 9 + i;
+      UNITS[18 + i][j] = ((i / 3) * 3 + j / 3) * 9 + (i % 3) * 3 + j % 3;
+    }
+  }
+
+  for (int cell = 0; cell < 81; cell++)
+  {
+    int row = cell / 9;
+    int col = cell % 9;
+    CELL_UNITS[cell][0] = row;
+    CELL_UNITS[cell][1] = 9 + col;
+    CELL_UNITS[cell][2] = 18 + (row / 3) * 3 + col / 3;
+
+    int count = 0;
+    for (int other = 0; other < 81; other++)
+    {
+      int r = other / 9;
+      int c = other % 9;
+      if (other != cell && (r == row || c == col || (r / 3 == row / 3 && c / 3 == col / 3)))
+        PEERS[cell][count++] = other;
+    }
+  }
+
+  tables_ready = true;
+}
+
+bool logic_init(Logic *logic, int board[9][9])
+{
+  init_tables();
+
+  logic->empty = 81;
+  logic->broken = false;
+  logic->last_cell = -1;
+  logic->last_digit = 0;
+  for (int cell = 0; cell < 81; cell++)
+  {
+    logic->board[cell] = 0;
+    logic->candidates[cell] = 0x1FF;
+  }
+  for (int unit = 0; unit < 27; unit++)
+  {
+    logic->placed[unit] = 0;
+    for (int digit = 0; digit < 9; digit++)
+      logic->counts[unit][digit] = 9;
+  }
+
+  for (int cell = 0; cell < 81; cell++)
+  {
+    int num = board[cell / 9][cell % 9];
+    if (num != 0)
+      logic_place(logic, cell, num - 1);
+  }
+
+  return !logic->broken;
+}
+
+void logic_eliminate(Logic *logic, int cell, int digit)
+{
+  uint16_t bit = 1 << digit;
+  if (!(logic->candidates[cell] & bit))
+    return;
+
+  logic->candidates[cell] &= ~bit;
+  for (int i = 0; i < 3; i++)
+  {
+    int unit = CELL_UNITS[cell][i];
+    logic->counts[unit][digit]--;
+    if (logic->counts[unit][digit] == 0 && !(logic->placed[unit] & bit))
+      logic->broken = true;
+  }
+
+  if (logic->candidates[cell] == 0 && logic->board[cell] == 0)
+    logic->broken = true;
+}
+
+void logic_place(Logic *logic, int cell, int digit)
+{
+  uint16_t bit = 1 << digit;
+  if (logic->board[cell] != 0 || !(logic->candidates[cell] & bit))
+  {
+    logic->broken = true;
+    return;
+  }
+
+  logic->board[cell] = digit + 1;
+  logic->empty--;
+  logic->last_cell = cell;
+  logic->last_digit = digit + 1;
+
+  for (int i = 0; i < 3; i++)
+    logic->placed[CELL_UNITS[cell][i]] |= bit;
+
+  uint16_t candidates = logic->candidates[cell];
+  while (candidates)
+  {
+    logic_eliminate(logic, cell, __builtin_ctz(candidates));
+    candidates &= candidates - 1;
+  }
+
+  for (int i = 0; i < 20; i++)
+    logic_eliminate(logic, PEERS[cell][i], digit);
+}
+
+bool find_naked_single(Logic *logic)
+{
+  for (int cell = 0; cell < 81; cell++)
+  {
+    if (logic->board[cell] == 0 && __builtin_popcount(logic->candidates[cell]) == 1)
+    {
+      logic_place(logic, cell, __builtin_ctz(logic->candidates[cell]));
+      return true;
+    }
+  }
+  return false;
+}
+
+bool find_hidden_single(Logic *logic)
+{
+  for (int unit = 0; unit < 27; unit++)
+  {
+    for (int digit = 0; digit < 9; digit++)
+    {
+      if (logic->counts[unit][digit] != 1 || (logic->placed[unit] & (1 << digit)))
+        continue;
+
+      for (int i = 0; i < 9; i++)
+      {
+        int cell = UNITS[unit][i];
+        if (logic->candidates[cell] & (1 << digit))
+        {
+          logic_place(logic, cell, digit);
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool find_naked_pair(Logic *logic)
+{
+  for (int unit = 0; unit < 27; unit++)
+  {
+    for (int i = 0; i < 9; i++)
+    {
+      uint16_t pair = logic->candidates[UNITS[unit][i]];
+      if (__builtin_popcount(pair) != 2)
+        continue;
+
+      for (int j = i + 1; j < 9; j++)
+      {
+        if (logic->candidates[UNITS[unit][j]] != pair)
+          continue;
+
+        bool progress = false;
+        for (int k = 0; k < 9; k++)
+        {
+          int cell = UNITS[unit][k];
+          if (k == i || k == j || !(logic->candidates[cell] & pair))
+            continue;
+          logic_eliminate(logic, cell, __builtin_ctz(pair));
+          logic_eliminate(logic, cell, 31 - __builtin_clz(pair));
+          progress = true;
+        }
+        if (progress)
+          return true;
+      }
+    }
+  }
+  return false;
+}
+
+uint16_t digit_positions(Logic *logic, int unit, int digit)
+{
+  uint16_t positions = 0;
+  for (int i = 0; i < 9; i++)
+  {
+    if (logic->candidates[UNITS[unit][i]] & (1 << digit))
+      positions |= 1 << i;
+  }
+  return positions;
+}
+
+bool find_hidden_pair(Logic *logic)
+{
+  for (int unit = 0; unit < 27; unit++)
+  {
+    for (int first = 0; first < 9; first++)
+    {
+      if (logic->counts[unit][first] != 2)
+        continue;
+      uint16_t positions = digit_positions(logic, unit, first);
+
+      for (int second = first + 1; second < 9; second++)
+      {
+        if (logic->counts[unit][second] != 2 || digit_positions(logic, unit, second) != positions)
+          continue;
+
+        uint16_t pair = (1 << first) | (1 << second);
+        bool progress = false;
+        for (int i = 0; i < 9; i++)
+        {
+          int cell = UNITS[unit][i];
+          uint16_t extra = logic->candidates[cell] & ~pair;
+          if (!(positions & (1 << i)) || extra == 0)
+            continue;
+          while (extra)
+          {
+            logic_eliminate(logic, cell, __builtin_ctz(extra));
+            extra &= extra - 1;
+          }
+          progress = true;
+        }
+        if (progress)
+          return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool eliminate_outside(Logic *logic, int unit, int digit, int keep_unit)
+{
+  bool progress = false;
+  for (int i = 0; i < 9; i++)
+  {
+    int cell = UNITS[unit][i];
+    bool kept = false;
+    for (int j = 0; j < 3; j++)
+      kept |= CELL_UNITS[cell][j] == keep_unit;
+    if (!kept && (logic->candidates[cell] & (1 << digit)))
+    {
+      logic_eliminate(logic, cell, digit);
+      progress = true;
+    }
+  }
+  return progress;
+}
+
+bool find_pointing(Logic *logic)
+{
+  for (int box = 18; box < 27; box++)
+  {
+    for (int digit = 0; digit < 9; digit++)
+    {
+      int count = logic->counts[box][digit];
+      if (count < 2 || count > 3)
+        continue;
+
+      int row = -1;
+      int col = -1;
+      for (int i = 0; i < 9; i++)
+      {
+        int cell = UNITS[box][i];
+        if (!(logic->candidates[cell] & (1 << digit)))
+          continue;
+        row = row == -1 || row == cell / 9 ? cell / 9 : -2;
+        col = col == -1 || col == cell % 9 ? cell % 9 : -2;
+      }
+
+      if (row >= 0 && eliminate_outside(logic, row, digit, box))
+        return true;
+      if (col >= 0 && eliminate_outside(logic, 9 + col, digit, box))
+        return true;
+    }
+  }
+  return false;
+}
+
+bool find_box_line(Logic *logic)
+{
+  for (int line = 0; line < 18; line++)
+  {
+    for (int digit = 0; digit < 9; digit++)
+    {
+      int count = logic->counts[line][digit];
+      if (count < 2 || count > 3)
+        continue;
+
+      int box = -1;
+      for (int i = 0; i < 9; i++)
+      {
+        int cell = UNITS[line][i];
+        if (!(logic->candidates[cell] & (1 << digit)))
+          continue;
+        int cell_box = CELL_UNITS[cell][2];
+        box = box == -1 || box == cell_box ? cell_box : -2;
+      }
+
+      if (box >= 0 && eliminate_outside(logic, box, digit, line))
+        return true;
+    }
+  }
+  return false;
+}
+
+bool find_x_wing(Logic *logic)
+{
+  for (int base = 0; base < 18; base += 9)
+  {
+    for (int digit = 0; digit < 9; digit++)
+    {
+      for (int first = base; first < base + 9; first++)
+      {
+        if (logic->counts[first][digit] != 2)
+          continue;
+        uint16_t positions = digit_positions(logic, first, digit);
+
+        for (int second = first + 1; second < base + 9; second++)
+        {
+          if (logic->counts[second][digit] != 2 || digit_positions(logic, second, digit) != positions)
+            continue;
+
+          bool progress = false;
+          int cover_base = base == 0 ? 9 : 0;
+          for (int i = 0; i < 9; i++)
+          {
+            if (!(positions & (1 << i)))
+              continue;
+            int cover = cover_base + i;
+            for (int j = 0; j < 9; j++)
+            {
+              int cell = UNITS[cover][j];
+              if (CELL_UNITS[cell][base == 0 ? 0 : 1] == first || CELL_UNITS[cell][base == 0 ? 0 : 1] == second)
+                continue;
+              if (logic->candidates[cell] & (1 << digit))
+              {
+                logic_eliminate(logic, cell, digit);
+                progress = true;
+              }
+            }
+          }
+          if (progress)
+            return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+Technique logic_step(Logic *logic)
+{
+  if (find_naked_single(logic))
+    return TECH_NAKED_SINGLE;
+  if (find_hidden_single(logic))
+    return TECH_HIDDEN_SINGLE;
+  if (find_naked_pair(logic))
+    return TECH_NAKED_PAIR;
+  if (find_hidden_pair(logic))
+    return TECH_HIDDEN_PAIR;
+  if (find_pointing(logic))
+    return TECH_POINTING;
+  if (find_box_line(logic))
+    return TECH_BOX_LINE;
+  if (find_x_wing(logic))
+    return TECH_X_WING;
+  return TECH_NONE;
+}
+
+Technique rate_puzzle(int board[9][9])
+{
+  Logic logic;
+  if (!logic_init(&logic, board))
+    return TECH_NONE;
+
+  Technique hardest = TECH_NAKED_SINGLE;
+  while (logic.empty > 0 && !logic.broken)
+  {
+    Technique technique = logic_step(&logic);
+    if (technique == TECH_NONE)
+      return TECH_GUESS;
+    if (technique > hardest)
+      hardest = technique;
+  }
+
+  return logic.broken ? TECH_NONE : hardest;
+}
+
+int technique_difficulty(Technique technique)
+{
+  if (technique <= TECH_HIDDEN_SINGLE)
+    return DIFFICULTY_EASY;
+  if (technique <= TECH_BOX_LINE)
+    return DIFFICULTY_MEDIUM;
+  return DIFFICULTY_HARD;
+}
+
+bool is_valid(GameState *state, int num, int row, int col)
+{
+  int self = state->board[row][col] == num ? 1 : 0;
+  int box = (row / state->box) * state->box + col / state->box;
+
+  return state->counts[0][row][num] == self &&
+         state->counts[1][col][num] == self &&
+         state->counts[2][box][num] == self;
+}
+
+void set_cell(GameState *state, int row, int col, int num)
+{
+  int units[3] = {row, col, (row / state->box) * state->box + col / state->box};
+  int old = state->board[row][col];
+
+  if (old != 0)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      if (--state->counts[i][units[i]][old] > 0)
+        state->conflicts--;
+    }
+    if (old == state->solution[row][col])
+      state->correct--;
+    if (old == state->witness[row][col])
+      state->witness_matches--;
+    state->filled--;
+  }
+
+  state->board[row][col] = num;
+
+  if (num != 0)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      if (state->counts[i][units[i]][num]++ > 0)
+        state->conflicts++;
+    }
+    if (num == state->solution[row][col])
+      state->correct++;
+    if (num == state->witness[row][col])
+      state->witness_matches++;
+    state->filled++;
+  }
+
+  if (old != num)
+  {
+    state->solvable_dirty = true;
+    if (state->logic_valid && old == 0 && state->box == 3)
+    {
+      logic_place(&state->logic, row * 9 + col, num - 1);
+      state->logic_valid = !state->logic.broken;
+    }
+    else
+      state->logic_valid = false;
+  }
+}
+
+void reset_counts(GameState *state)
+{
+  int board[MAX_SIZE][MAX_SIZE];
+  memcpy(board, state->board, sizeof(board));
+  memset(state->board, 0, sizeof(state->board));
+  memset(state->counts, 0, sizeof(state->counts));
+  memcpy(state->witness, state->solution, sizeof(state->witness));
+  state->correct = 0;
+  state->conflicts = 0;
+  state->filled = 0;
+  state->witness_matches = 0;
+  state->solvable = SOLVABLE_YES;
+  state->solvable_dirty = false;
+  state->logic_valid = false;
+  state->message[0] = '\0';
+
+  for (int row = 0; row < state->size; row++)
+  {
+    for (int col = 0; col < state->size; col++)
+      set_cell(state, row, col, board[row][col]);
+  }
+}
+
+int check_solvable(GameState *state)
+{
+  if (!state->solvable_dirty)
+    return state->solvable;
+  state->solvable_dirty = false;
+
+  if (state->conflicts > 0)
+    return state->solvable = SOLVABLE_NO;
+  if (state->witness_matches == state->filled)
+    return state->solvable = SOLVABLE_YES;
+
+  int found[MAX_SIZE][MAX_SIZE];
+  memcpy(found, state->board, sizeof(found));
+
+  if (state->box == 3)
+  {
+    state->solvable = solve_grid(3, found) ? SOLVABLE_YES : SOLVABLE_NO;
+  }
+  else
+  {
+    Dlx dlx;
+    dlx_init(&dlx, state->box);
+    dlx.budget = DLX_CHECK_BUDGET;
+    int result = dlx_load(&dlx, found) ? dlx_search(&dlx, 1, false, found) : 0;
+    if (dlx.budget == 0)
+      state->solvable = SOLVABLE_UNKNOWN;
+    else
+      state->solvable = result == 1 ? SOLVABLE_YES : SOLVABLE_NO;
+    dlx_free(&dlx);
+  }
+
+  if (state->solvable == SOLVABLE_YES)
+  {
+    memcpy(state->witness, found, sizeof(state->witness));
+    state->witness_matches = state->filled;
+  }
+  return state->solvable;
+}
+
+void give_hint(GameState *state)
+{
+  int solvable = check_solvable(state);
+
+  if (solvable == SOLVABLE_NO)
+  {
+    for (int row = 0; row < state->size; row++)
+    {
+      for (int col = 0; col < state->size; col++)
+      {
+        int num = state->board[row][col];
+        if (num != 0 && !state->fixed[row][col] && (num != state->witness[row][col] || !is_valid(state, num, row, col)))
+        {
+          state->cursor = (vec2){col, row};
+          snprintf(state->message, sizeof(state->message), "Há um erro na linha %d, coluna %d", row + 1, col + 1);
+          return;
+        }
+      }
+    }
+  }
+
+  int cell = -1;
+  int num = 0;
+  Technique technique = TECH_NAKED_SINGLE;
+  bool found = state->box == 3 ? find_logic_hint(state, &cell, &num, &technique) : find_single_hint(state, &cell, &num);
+
+  if (!found && solvable == SOLVABLE_YES)
+  {
+    for (int i = 0; i < state->size * state->size && !found; i++)
+    {
+      if (state->board[i / state->size][i % state->size] == 0)
+      {
+        cell = i;
+        num = state->witness[i / state->size][i % state->size];
+        technique = TECH_GUESS;
+        found = true;
+      }
+    }
+  }
+
+  if (!found)
+  {
+    snprintf(state->message, sizeof(state->message), "Nenhuma dica disponível");
+    return;
+  }
+
+  state->cursor = (vec2){cell % state->size, cell / state->size};
+  snprintf(state->message, sizeof(state->message), "Dica: %c na linha %d, coluna %d (%s)",
+           SYMBOLS[num], cell / state->size + 1, cell % state->size + 1, TECHNIQUE_NAMES[technique]);
+}
+
+bool find_logic_hint(GameState *state, int *cell, int *num, Technique *technique)
+{
+  if (!state->logic_valid)
+  {
+    int board[9][9];
+    for (int row = 0; row < 9; row++)
+      memcpy(board[row], state->board[row], sizeof(board[row]));
+    state->logic_valid = logic_init(&state->logic, board);
+    if (!state->logic_valid)
+      return false;
+  }
+
+  Logic logic = state->logic;
+  int empty = logic.empty;
+  *technique = TECH_NONE;
+  while (logic.empty == empty)
+  {
+    Technique step = logic_step(&logic);
+    if (step == TECH_NONE || logic.broken)
+      return false;
+    if (step > *technique)
+      *technique = step;
+  }
+
+  *cell = logic.last_cell;
+  *num = logic.last_digit;
+  return true;
+}
+
+bool find_single_hint(GameState *state, int *cell, int *num)
+{
+  for (int row = 0; row < state->size; row++)
+  {
+    for (int col = 0; col < state->size; col++)
+    {
+      if (state->board[row][col] != 0)
+        continue;
+
+      int box = (row / state->box) * state->box + col / state->box;
+      int options = 0;
+      for (int digit = 1; digit <= state->size && options < 2; digit++)
+      {
+        if (state->counts[0][row][digit] == 0 && state->counts[1][col][digit] == 0 && state->counts[2][box][digit] == 0)
+        {
+          *num = digit;
+          options++;
+        }
+      }
+
+      if (options == 1)
+      {
+        *cell = row * state->size + col;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+vec2 cell_to_screen(GameState *state, vec2 cell)
+{
+  vec2 screen;
+  screen.x = cell.x * 2 + 2 + (cell.x / state->box) * 2;
+  screen.y = cell.y + 1 + cell.y / state->box;
+  return screen;
+}
+
+void game_loop(GameState *state, WINDOW *win)
+{
+  int help_y = state->box * (state->box + 1) + 1;
+
+  while (!is_winner(state))
+  {
+    handle_input(state, win);
+
+    erase();
+    draw_table(state);
+    if (state->size > 9)
+      mvprintw(help_y, 0, "Use setas para mover | 1-9/A-%c inserir | 0/DEL para apagar | ? dica | ESC para sair", SYMBOLS[state->size]);
+    else
+      mvprintw(help_y, 0, "Use setas para mover | 1-9 inserir | 0/DEL para apagar | ? dica | ESC para sair");
+    mvprintw(help_y + 1, 0, "Solucionável: %s", SOLVABLE_NAMES[check_solvable(state)]);
+    mvprintw(help_y + 2, 0, "%s", state->message);
+    refresh();
+    usleep(50000);
+  }
+}
+
+bool is_winner(GameState *state)
+{
+  return state->correct == state->size * state->size && state->conflicts == 0;
+}
+
+void handle_input(GameState *state, WINDOW *win)
+{
+  int pressed = wgetch(win);
+
+  if (pressed == KEY_UP)
+  {
+    state->cursor.y--;
+    if (state->cursor.y < 0)
+      state->cursor.y = state->size - 1;
+  }
+  else if (pressed == KEY_DOWN)
+  {
+    state->cursor.y++;
+    if (state->cursor.y >= state->size)
+      state->cursor.y = 0;
+  }
+  else if (pressed == KEY_RIGHT)
+  {
+    state->cursor.x++;
+    if (state->cursor.x >= state->size)
+      state->cursor.x = 0;
+  }
+  else if (pressed == KEY_LEFT)
+  {
+    state->cursor.x--;
+    if (state->cursor.x < 0)
+      state->cursor.x = state->size - 1;
+  }
+
+  if (pressed == '?')
+  {
+    give_hint(state);
+    return;
+  }
+
+  int num = 0;
+  if (pressed >= '1' && pressed <= '9')
+    num = pressed - '0';
+  else if (pressed >= 'a' && pressed <= 'z')
+    num = pressed - 'a' + 10;
+  else if (pressed >= 'A' && pressed <= 'Z')
+    num = pressed - 'A' + 10;
+
+  vec2 cell = state->cursor;
+  if (!state->fixed[cell.y][cell.x])
+  {
+    if (num >= 1 && num <= state->size)
+    {
+      set_cell(state, cell.y, cell.x, num);
+      state->message[0] = '\0';
+    }
+    else if (pressed == '0' || pressed == KEY_BACKSPACE || pressed == KEY_DC)
+    {
+      set_cell(state, cell.y, cell.x, 0);
+      state->message[0] = '\0';
+    }
+  }
+
+  if (pressed == 27)
+  {
+    endwin();
+    exit(0);
+  }
+}
+
+void draw_table(GameState *state)
+{
+  int box = state->box;
+  int width = box * (box * 2 + 2);
+  int height = box * (box + 1);
+
+  for (int row = 0; row <= box; row++)
+  {
+    int y = row * (box + 1);
+    for (int x = 0; x <= width; x++)
+    {
+      if (x % (box * 2 + 2) == 0)
+      {
+        mvaddch(y, x, '+');
+      }
+      else
+      {
+        mvaddch(y, x, '-');
+      }
+    }
+  }
+
+  for (int col = 0; col <= box; col++)
+  {
+    int x = col * (box * 2 + 2);
+    for (int y = 1; y < height; y++)
+    {
+      if (y % (box + 1) == 0)
+        continue;
+      mvaddch(y, x, '|');
+    }
+  }
+
+  for (int row = 0; row < state->size; row++)
+  {
+    for (int col = 0; col < state->size; col++)
+    {
+      vec2 screen = cell_to_screen(state, (vec2){col, row});
+
+      if (state->cursor.x == col && state->cursor.y == row)
+      {
+        attron(A_REVERSE);
+      }
+
+      if (state->board[row][col] == 0)
+      {
+        mvaddch(screen.y, screen.x, '.');
+      }
+      else
+      {
+        int num = state->board[row][col];
+        attr_t attrs = 0;
+        if (state->fixed[row][col])
+          attrs |= A_BOLD;
+        if (!is_valid(state, num, row, col))
+          attrs |= A_UNDERLINE | COLOR_PAIR(1);
+
+        attron(attrs);
+        mvaddch(screen.y, screen.x, SYMBOLS[num]);
+        attroff(attrs);
+      }
+
+      attroff(A_REVERSE);
+    }
+  }
+}
+
+int run_batch(const char *path)
+{
+  BatchReader reader;
+  if (!batch_open(&reader, path))
+  {
+    fprintf(stderr, "Não foi possível abrir %s\n", path);
+    return 1;
+  }
+
+  long threads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads < 1)
+    threads = 1;
+  if (threads > BATCH_MAX_THREADS)
+    threads = BATCH_MAX_THREADS;
+
+  BatchWindow window;
+  window.lines = malloc(BATCH_WINDOW * sizeof(const char *));
+  window.lengths = malloc(BATCH_WINDOW * sizeof(size_t));
+  window.output = malloc(BATCH_WINDOW * 82);
+  window.threads = threads;
+  window.job = 0;
+  window.active = 0;
+  window.stop = false;
+  pthread_mutex_init(&window.lock, NULL);
+  pthread_cond_init(&window.wake, NULL);
+  pthread_cond_init(&window.done, NULL);
+
+  // The pool lives for the whole run; the calling thread drains queue 0.
+  pthread_t workers[BATCH_MAX_THREADS];
+  BatchWorker args[BATCH_MAX_THREADS];
+  for (int i = 1; i < threads; i++)
+  {
+    args[i].window = &window;
+    args[i].id = i;
+    pthread_create(&workers[i], NULL, batch_worker, &args[i]);
+  }
+
+  long total = 0;
+  long unsolved = 0;
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  while ((window.count = batch_next_window(&reader, window.lines, window.lengths)) > 0)
+  {
+    int chunks = (window.count + BATCH_CHUNK - 1) / BATCH_CHUNK;
+    for (int i = 0; i < threads; i++)
+    {
+      atomic_init(&window.queues[i].next, chunks * i / threads);
+      window.queues[i].end = chunks * (i + 1) / threads;
+    }
+    atomic_init(&window.unsolved, 0);
+
+    pthread_mutex_lock(&window.lock);
+    window.active = threads - 1;
+    window.job++;
+    pthread_cond_broadcast(&window.wake);
+    pthread_mutex_unlock(&window.lock);
+
+    batch_drain(&window, 0);
+
+    pthread_mutex_lock(&window.lock);
+    while (window.active > 0)
+      pthread_cond_wait(&window.done, &window.lock);
+    pthread_mutex_unlock(&window.lock);
+
+    fwrite(window.output, 82, window.count, stdout);
+    total += window.count;
+    unsolved += atomic_load(&window.unsolved);
+  }
+
+  pthread_mutex_lock(&window.lock);
+  window.stop = true;
+  window.job++;
+  pthread_cond_broadcast(&window.wake);
+  pthread_mutex_unlock(&window.lock);
+  for (int i = 1; i < threads; i++)
+    pthread_join(workers[i], NULL);
+
+  fflush(stdout);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  fprintf(stderr, "%ld puzzles em %.3f s (%.0f puzzles/s, %ld threads, %ld sem solução)\n",
+          total, seconds, seconds > 0 ? total / seconds : 0.0, threads, unsolved);
+
+  free(window.lines);
+  free(window.lengths);
+  free(window.output);
+  pthread_mutex_destroy(&window.lock);
+  pthread_cond_destroy(&window.wake);
+  pthread_cond_destroy(&window.done);
+  batch_close(&reader);
+  return 0;
+}
+
+bool batch_open(BatchReader *reader, const char *path)
+{
+  memset(reader, 0, sizeof(*reader));
+
+  if (path == NULL || strcmp(path, "-") == 0)
+  {
+    reader->stream = stdin;
+  }
+  else
+  {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+      void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED)
+      {
+        madvise(map, info.st_size, MADV_SEQUENTIAL);
+        reader->data = map;
+        reader->size = info.st_size;
+        reader->mapped = true;
+        close(fd);
+        return true;
+      }
+    }
+
+    reader->stream = fdopen(fd, "r");
+    if (reader->stream == NULL)
+    {
+      close(fd);
+      return false;
+    }
+  }
+
+  reader->buffer = malloc(BATCH_BUFFER);
+  reader->data = reader->buffer;
+  return true;
+}
+
+void batch_close(BatchReader *reader)
+{
+  if (reader->mapped)
+    munmap((void *)reader->data, reader->size);
+  else
+  {
+    free(reader->buffer);
+    if (reader->stream != stdin)
+      fclose(reader->stream);
+  }
+}
+
+int batch_next_window(BatchReader *reader, const char **lines, size_t *lengths)
+{
+  if (!reader->mapped)
+  {
+    size_t left = reader->size - reader->offset;
+    memmove(reader->buffer, reader->buffer + reader->offset, left);
+    reader->size = left;
+    reader->offset = 0;
+    if (!reader->eof)
+    {
+      reader->size += fread(reader->buffer + left, 1, BATCH_BUFFER - left, reader->stream);
+      reader->eof = reader->size < BATCH_BUFFER;
+    }
+  }
+
+  int count = 0;
+  while (count < BATCH_WINDOW && reader->offset < reader->size)
+  {
+    const char *start = reader->data + reader->offset;
+    size_t left = reader->size - reader->offset;
+    const char *newline = memchr(start, '\n', left);
+    size_t length = newline ? (size_t)(newline - start) : left;
+
+    if (newline == NULL && !reader->mapped && !reader->eof && reader->offset > 0)
+      break;
+
+    reader->offset += newline ? length + 1 : length;
+    if (length > 0 && start[length - 1] == '\r')
+      length--;
+    if (length == 0 || start[0] == '#')
+      continue;
+
+    lines[count] = start;
+    lengths[count] = length;
+    count++;
+  }
+
+  return count;
+}
+
+void *batch_worker(void *arg)
+{
+  BatchWorker *worker = arg;
+  BatchWindow *window = worker->window;
+  int seen = 0;
+
+  pthread_mutex_lock(&window->lock);
+  while (true)
+  {
+    while (window->job == seen)
+      pthread_cond_wait(&window->wake, &window->lock);
+    seen = window->job;
+    if (window->stop)
+      break;
+    pthread_mutex_unlock(&window->lock);
+
+    batch_drain(window, worker->id);
+
+    pthread_mutex_lock(&window->lock);
+    if (--window->active == 0)
+      pthread_cond_signal(&window->done);
+  }
+  pthread_mutex_unlock(&window->lock);
+  return NULL;
+}
+
+// Works through this thread's own queue first, then steals chunks from the others.
+void batch_drain(BatchWindow *window, int id)
+{
+  for (int i = 0; i < window->threads; i++)
+  {
+    BatchQueue *queue = &window->queues[(id + i) % window->threads];
+    int chunk;
+    while ((chunk = atomic_fetch_add(&queue->next, 1)) < queue->end)
+    {
+      int first = chunk * BATCH_CHUNK;
+      int last = first + BATCH_CHUNK < window->count ? first + BATCH_CHUNK : window->count;
+      for (int j = first; j < last; j++)
+      {
+        if (!solve_line(window->lines[j], window->lengths[j], window->output + j * 82))
+          atomic_fetch_add(&window->unsolved, 1);
+      }
+    }
+  }
+}
+
+bool solve_line(const char *line, size_t length, char *out)
+{
+  int board[9][9];
+  bool parsed = length >= 81;
+
+  for (int i = 0; i < 81; i++)
+  {
+    char c = i < (int)length ? line[i] : '.';
+    out[i] = c;
+    if (c >= '1' && c <= '9')
+      board[i / 9][i % 9] = c - '0';
+    else if (c == '.' || c == '0')
+      board[i / 9][i % 9] = 0;
+    else
+      parsed = false;
+  }
+  out[81] = '\n';
+
+  if (!parsed)
+    return false;
+
+  Grid grid;
+  Grid solution;
+  if (!grid_load(&grid, board) || grid_search(&grid, 1, false, &solution) != 1)
+    return false;
+
+  grid_store(&solution, board);
+  for (int i = 0; i < 81; i++)
+    out[i] = '0' + board[i / 9][i % 9];
+  return true;
+}
+
+bool bank_open(Bank *bank, const char *path)
+{
+  memset(bank, 0, sizeof(*bank));
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(BankHeader))
+  {
+    close(fd);
+    return false;
+  }
+
+  void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return false;
+
+  const BankHeader *header = map;
+  size_t records = (info.st_size - sizeof(BankHeader)) / sizeof(BankRecord);
+  bool valid = memcmp(header->magic, BANK_MAGIC, sizeof(header->magic)) == 0 &&
+               header->record_size == sizeof(BankRecord);
+  for (int i = DIFFICULTY_EASY; i <= DIFFICULTY_HARD && valid; i++)
+    valid = (size_t)header->offsets[i] + header->counts[i] <= records;
+
+  if (!valid)
+  {
+    munmap(map, info.st_size);
+    return false;
+  }
+
+  bank->data = map;
+  bank->size = info.st_size;
+  bank->header = header;
+  bank->records = (const BankRecord *)(bank->data + sizeof(BankHeader));
+  return true;
+}
+
+bool bank_pick(const Bank *bank, GameState *state, int difficulty)
+{
+  if (bank->header == NULL || bank->header->counts[difficulty] == 0)
+    return false;
+
+  uint32_t index = ((uint32_t)rand() * (uint64_t)RAND_MAX + rand()) % bank->header->counts[difficulty];
+  const BankRecord *record = &bank->records[bank->header->offsets[difficulty] + index];
+
+  memset(state->solution, 0, sizeof(state->solution));
+  for (int cell = 0; cell < 81; cell++)
+  {
+    int row = cell / 9;
+    int col = cell % 9;
+    int num = (record->solution[cell / 2] >> ((cell % 2) * 4)) & 0xF;
+    bool given = (record->givens[cell / 8] >> (cell % 8)) & 1;
+
+    state->solution[row][col] = num;
+    state->board[row][col] = given ? num : 0;
+    state->fixed[row][col] = given;
+  }
+
+  return true;
+}
+
+void bank_pack(BankRecord *record, int board[9][9], int solution[9][9], Technique technique)
+{
+  memset(record, 0, sizeof(*record));
+  for (int cell = 0; cell < 81; cell++)
+  {
+    int row = cell / 9;
+    int col = cell % 9;
+    record->solution[cell / 2] |= solution[row][col] << ((cell % 2) * 4);
+    if (board[row][col] != 0)
+      record->givens[cell / 8] |= 1 << (cell % 8);
+  }
+  record->technique = technique;
+}
+
+int build_bank(const char *path, int count)
+{
+  if (count <= 0)
+  {
+    fprintf(stderr, "Quantidade inválida de puzzles\n");
+    return 1;
+  }
+
+  BankRecord *records[3];
+  uint32_t filled[3] = {0};
+  for (int i = DIFFICULTY_EASY; i <= DIFFICULTY_HARD; i++)
+    records[i] = malloc(count * sizeof(BankRecord));
+
+  GameState state;
+  state.box = 3;
+  state.size = 9;
+
+  long generated = 0;
+  while (filled[DIFFICULTY_EASY] < (uint32_t)count || filled[DIFFICULTY_MEDIUM] < (uint32_t)count || filled[DIFFICULTY_HARD] < (uint32_t)count)
+  {
+    memset(state.solution, 0, sizeof(state.solution));
+    solve_grid(3, state.solution);
+    dig_puzzle(&state);
+    generated++;
+
+    int board[9][9];
+    int solution[9][9];
+    for (int row = 0; row < 9; row++)
+    {
+      memcpy(board[row], state.board[row], sizeof(board[row]));
+      memcpy(solution[row], state.solution[row], sizeof(solution[row]));
+    }
+
+    Technique technique = rate_puzzle(board);
+    int difficulty = technique_difficulty(technique);
+    if (filled[difficulty] < (uint32_t)count)
+      bank_pack(&records[difficulty][filled[difficulty]++], board, solution, technique);
+
+    if (generated % 10000 == 0)
+      fprintf(stderr, "%ld gerados: %u/%u/%u\n", generated, filled[0], filled[1], filled[2]);
+  }
+
+  FILE *file = fopen(path, "wb");
+  if (file == NULL)
+  {
+    fprintf(stderr, "Não foi possível criar %s\n", path);
+    return 1;
+  }
+
+  BankHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, BANK_MAGIC, sizeof(header.magic));
+  header.record_size = sizeof(BankRecord);
+  for (int i = DIFFICULTY_EASY; i <= DIFFICULTY_HARD; i++)
+  {
+    header.counts[i] = filled[i];
+    header.offsets[i] = i == 0 ? 0 : header.offsets[i - 1] + header.counts[i - 1];
+  }
+
+  fwrite(&header, sizeof(header), 1, file);
+  for (int i = DIFFICULTY_EASY; i <= DIFFICULTY_HARD; i++)
+  {
+    fwrite(records[i], sizeof(BankRecord), filled[i], file);
+    free(records[i]);
+  }
+  fclose(file);
+
+  fprintf(stderr, "%s: %d puzzles por dificuldade (%ld gerados)\n", path, count, generated);
+  return 0;
+}
+
+int run_bench(int argc, char **argv)
+{
+  static const char *keys[] = {"easy", "medium", "hard"};
+  const char *sets[64];
+  int set_count = 0;
+  for (int i = 1; i < argc && set_count < 64; i++)
+  {
+    if (strncmp(argv[i], "--", 2) != 0)
+      sets[set_count++] = argv[i];
+  }
+  if (set_count == 0)
+  {
+    for (size_t i = 0; i < sizeof(BENCH_SETS) / sizeof(BENCH_SETS[0]); i++)
+      sets[set_count++] = BENCH_SETS[i];
+  }
+
+  for (int i = 0; i < set_count; i++)
+  {
+    int (*boards)[9][9] = NULL;
+    int count = bench_load(sets[i], &boards);
+    if (count < 0)
+    {
+      fprintf(stderr, "Não foi possível abrir %s\n", sets[i]);
+      return 1;
+    }
+
+    const char *name = strrchr(sets[i], '/');
+    name = name != NULL ? name + 1 : sets[i];
+    double *latencies = malloc((count > 0 ? count : 1) * sizeof(double));
+
+    int failed = 0;
+    search_stats = (SearchStats){0};
+    for (int j = 0; j < count; j++)
+    {
+      struct timespec start, end;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      Grid grid;
+      Grid solution;
+      bool solved = grid_load(&grid, boards[j]) && grid_search(&grid, 1, false, &solution) == 1;
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      latencies[j] = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+      failed += !solved;
+    }
+    SearchStats stats = search_stats;
+    bench_report("solve", name, latencies, count, failed, &stats);
+
+    failed = 0;
+    search_stats = (SearchStats){0};
+    for (int j = 0; j < count; j++)
+    {
+      struct timespec start, end;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      int solutions = count_solutions(boards[j], 2);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      latencies[j] = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+      failed += solutions != 1;
+    }
+    stats = search_stats;
+    bench_report("count", name, latencies, count, failed, &stats);
+
+    free(latencies);
+    free(boards);
+  }
+
+  GameState *state = malloc(sizeof(GameState));
+  double latencies[BENCH_GENERATE];
+  for (int box = 3; box <= 4; box++)
+  {
+    for (int difficulty = box == 3 ? DIFFICULTY_EASY : DIFFICULTY_HARD; difficulty <= DIFFICULTY_HARD; difficulty++)
+    {
+      int runs = box == 3 ? BENCH_GENERATE : BENCH_GENERATE_LARGE;
+      int failed = 0;
+      srand(BENCH_SEED);
+      search_stats = (SearchStats){0};
+      for (int j = 0; j < runs; j++)
+      {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        init_game_state(state, box, difficulty);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        latencies[j] = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+
+        if (box == 3)
+        {
+          int board[9][9];
+          for (int row = 0; row < 9; row++)
+            memcpy(board[row], state->board[row], sizeof(board[row]));
+          failed += technique_difficulty(rate_puzzle(board)) != difficulty;
+        }
+      }
+
+      char name[32];
+      snprintf(name, sizeof(name), "%dx%d-%s", box * box, box * box, keys[difficulty]);
+      SearchStats stats = search_stats;
+      bench_report("generate", name, latencies, runs, failed, &stats);
+    }
+  }
+
+  free(state);
+  return 0;
+}
+
+int bench_load(const char *path, int (**boards)[9][9])
+{
+  FILE *file = fopen(path, "r");
+  if (file == NULL)
+    return -1;
+
+  int count = 0;
+  int capacity = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+    if (strlen(line) < 81 || line[0] == '#')
+      continue;
+
+    if (count == capacity)
+    {
+      capacity = capacity == 0 ? 256 : capacity * 2;
+      *boards = realloc(*boards, capacity * sizeof(**boards));
+    }
+
+    bool parsed = true;
+    for (int i = 0; i < 81; i++)
+    {
+      char c = line[i];
+      if (c >= '1' && c <= '9')
+        (*boards)[count][i / 9][i % 9] = c - '0';
+      else if (c == '.' || c == '0')
+        (*boards)[count][i / 9][i % 9] = 0;
+      else
+        parsed = false;
+    }
+    count += parsed;
+  }
+
+  fclose(file);
+  return count;
+}
+
+void bench_report(const char *bench, const char *set, double *latencies, int count, int failed, SearchStats *stats)
+{
+  double total = 0;
+  for (int i = 0; i < count; i++)
+    total += latencies[i];
+  qsort(latencies, count, sizeof(double), compare_latency);
+
+  double p50 = count > 0 ? latencies[count / 2] : 0;
+  double p90 = count > 0 ? latencies[count * 9 / 10] : 0;
+  double p99 = count > 0 ? latencies[count * 99 / 100] : 0;
+  double max = count > 0 ? latencies[count - 1] : 0;
+
+  printf("{\"bench\":\"%s\",\"set\":\"%s\",\"kernel\":\"%s\",\"count\":%d,\"failed\":%d,"
+         "\"per_second\":%.1f,\"mean_us\":%.2f,\"p50_us\":%.2f,\"p90_us\":%.2f,\"p99_us\":%.2f,\"max_us\":%.2f,"
+         "\"nodes\":%ld,\"guesses\":%ld,\"backtracks\":%ld}\n",
+         bench, set, propagate == propagate_scalar ? "scalar" : "vector", count, failed,
+         total > 0 ? count / (total / 1e6) : 0.0, count > 0 ? total / count : 0.0, p50, p90, p99, max,
+         stats->nodes, stats->guesses, stats->backtracks);
+  fflush(stdout);
+}
+
+int compare_latency(const void *a, const void *b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}